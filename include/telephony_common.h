@@ -22,6 +22,7 @@
  * @brief This file contains telephony common APIs and related enumerations.
  */
 
+#include <stddef.h>
 #include <tizen.h>
 
 #ifdef __cplusplus
@@ -114,6 +115,14 @@ typedef void (*telephony_noti_cb)(telephony_h handle, telephony_noti_e noti_id,
  * @privlevel public
  * @privilege %http://tizen.org/privilege/telephony
  *
+ * @remarks Several callbacks can be set for the same @a noti_id, they are all invoked
+ *          in the order they have been set. \n
+ *          Call and SIM notifications are delivered ahead of network notifications received before them. \n
+ *          Network notifications are coalesced: they are delivered one per main loop iteration, at the default
+ *          priority, and if a property changes several times before its notification is delivered, only its
+ *          latest value is delivered. The replaced values are counted in @a suppressed of
+ *          #telephony_noti_stats_s.
+ *
  * @param[in] handle  The handle to use the telephony API
  * @param[in] noti_id The notification ID to set the callback
  * @param[in] cb The callback to be invoked when the telephony state changes
@@ -142,6 +151,9 @@ int telephony_set_noti_cb(telephony_h handle,
  * @privlevel public
  * @privilege %http://tizen.org/privilege/telephony
  *
+ * @remarks If several callbacks have been set for @a noti_id, the earliest one is unset. \n
+ *          It can be called from telephony_noti_cb(), including for its own @a noti_id.
+ *
  * @param[in] handle  The handle to use the telephony API
  * @param[in] noti_id The notification ID to unset a callback
  *
@@ -158,6 +170,572 @@ int telephony_set_noti_cb(telephony_h handle,
  */
 int telephony_unset_noti_cb(telephony_h handle, telephony_noti_e noti_id);
 
+/**
+ * @brief Sets a callback function for several notifications at once.
+ *
+ * @since_tizen 3.0
+ * @privlevel public
+ * @privilege %http://tizen.org/privilege/telephony
+ *
+ * @remarks It is the same as calling telephony_set_noti_cb() for each element of @a noti_ids,
+ *          except that no callback is set if any of them fails.
+ *
+ * @param[in] handle  The handle to use the telephony API
+ * @param[in] noti_ids The array of notification IDs to set the callback
+ * @param[in] count The number of elements in @a noti_ids
+ * @param[in] cb The callback to be invoked when the telephony state changes
+ * @param[in] user_data The user data passed to the callback function
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_PERMISSION_DENIED Permission denied
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ * @retval #TELEPHONY_ERROR_OPERATION_FAILED  Operation failed
+ *
+ * @post telephony_noti_cb() will be invoked.
+ *
+ * @see telephony_set_noti_cb()
+ * @see telephony_unset_noti_cb_many()
+ */
+int telephony_set_noti_cb_many(telephony_h handle, const telephony_noti_e *noti_ids,
+    unsigned int count, telephony_noti_cb cb, void *user_data);
+
+/**
+ * @brief Unsets a callback function for several notifications at once.
+ *
+ * @since_tizen 3.0
+ * @privlevel public
+ * @privilege %http://tizen.org/privilege/telephony
+ *
+ * @remarks It is the same as calling telephony_unset_noti_cb() for each element of @a noti_ids.
+ *
+ * @param[in] handle  The handle to use the telephony API
+ * @param[in] noti_ids The array of notification IDs to unset a callback
+ * @param[in] count The number of elements in @a noti_ids
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_PERMISSION_DENIED Permission denied
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ * @retval #TELEPHONY_ERROR_OPERATION_FAILED  Operation failed
+ *
+ * @see telephony_unset_noti_cb()
+ * @see telephony_set_noti_cb_many()
+ */
+int telephony_unset_noti_cb_many(telephony_h handle, const telephony_noti_e *noti_ids,
+    unsigned int count);
+
+/**
+ * @brief The structure type for the delivery policy of a notification callback.
+ * @since_tizen 3.0
+ */
+typedef struct {
+    unsigned int min_interval_ms; /**< Minimum time between two invocations of the callback in milliseconds, @c 0 for no limit */
+    bool trailing_edge; /**< @c true to deliver the latest notification received during the interval once it ends, @c false to drop them */
+} telephony_noti_policy_s;
+
+/**
+ * @brief Definition for the number of buckets of the histograms of #telephony_noti_stats_s.
+ * @details Bucket @c i counts the durations from 2^i to 2^(i+1) microseconds, the first one also counts
+ *          the durations under a microsecond and the last one every longer duration.
+ * @since_tizen 3.0
+ */
+#define TELEPHONY_NOTI_HISTOGRAM_BUCKETS 20
+
+/**
+ * @brief The structure type for the delivery counters of a notification.
+ * @since_tizen 3.0
+ */
+typedef struct {
+    unsigned int delivered; /**< Number of notifications delivered to the application */
+    unsigned int suppressed; /**< Number of notifications dropped or coalesced by a #telephony_noti_policy_s, or replaced by a later network notification before delivery */
+    unsigned int filtered; /**< Number of notifications dropped because their value did not change, see telephony_set_noti_filter() */
+    unsigned int slow; /**< Number of callback invocations longer than the budget, see telephony_set_noti_callback_budget() */
+    unsigned int latency_histogram[TELEPHONY_NOTI_HISTOGRAM_BUCKETS]; /**< Time from the reception of a notification to the invocation of a callback */
+    unsigned int duration_histogram[TELEPHONY_NOTI_HISTOGRAM_BUCKETS]; /**< Time spent in a callback */
+} telephony_noti_stats_s;
+
+/**
+ * @brief The structure type for the timing of the notification being delivered.
+ * @details Times are in microseconds of the monotonic clock.
+ * @since_tizen 3.0
+ */
+typedef struct {
+    unsigned long long received; /**< Time the notification reached the telephony library */
+    unsigned long long dispatched; /**< Time the library started to deliver it, after waiting for its turn in the main loop */
+    unsigned long long callback_start; /**< Time the running callback was invoked */
+} telephony_noti_timing_s;
+
+/**
+ * @brief Gets the timing of the notification being delivered to the calling callback.
+ *
+ * @since_tizen 3.0
+ *
+ * @remarks It must be called from inside telephony_noti_cb(), the values are about the notification it received.
+ *
+ * @param[out] timing The timing of the notification
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter, or not called from a callback
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ *
+ * @see telephony_get_noti_stats()
+ */
+int telephony_noti_get_timing(telephony_noti_timing_s *timing);
+
+/**
+ * @brief Sets a callback function to be invoked when the telephony state changes, at a limited rate.
+ *
+ * @since_tizen 3.0
+ * @privlevel public
+ * @privilege %http://tizen.org/privilege/telephony
+ *
+ * @remarks It is the same as telephony_set_noti_cb(), except that the callback is invoked
+ *          at most once per @a policy->min_interval_ms. \n
+ *          The notifications received in between are dropped, or if @a policy->trailing_edge is @c true,
+ *          only the latest of them is delivered when the interval ends. \n
+ *          The callback is unset with telephony_unset_noti_cb().
+ *
+ * @param[in] handle  The handle to use the telephony API
+ * @param[in] noti_id The notification ID to set the callback
+ * @param[in] policy The delivery policy of the callback
+ * @param[in] cb The callback to be invoked when the telephony state changes
+ * @param[in] user_data The user data passed to the callback function
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_PERMISSION_DENIED Permission denied
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ * @retval #TELEPHONY_ERROR_OPERATION_FAILED  Operation failed
+ *
+ * @post telephony_noti_cb() will be invoked.
+ *
+ * @see telephony_set_noti_cb()
+ * @see telephony_get_noti_stats()
+ */
+int telephony_set_noti_cb_with_policy(telephony_h handle, telephony_noti_e noti_id,
+    const telephony_noti_policy_s *policy, telephony_noti_cb cb, void *user_data);
+
+/**
+ * @brief Definition for the number of distinct slow callbacks tracked by a handle.
+ * @since_tizen 3.0
+ */
+#define TELEPHONY_NOTI_SLOW_CALLBACKS_MAX 16
+
+/**
+ * @brief The structure type for a callback which ran longer than the budget of its handle.
+ * @since_tizen 3.0
+ */
+typedef struct {
+    telephony_noti_cb cb; /**< The callback */
+    telephony_noti_e noti_id; /**< The notification ID it was set for */
+    unsigned int count; /**< Number of invocations longer than the budget */
+    unsigned int max_duration_us; /**< Longest invocation in microseconds */
+} telephony_noti_slow_callback_s;
+
+/**
+ * @brief Sets the time a notification callback may take before it is reported as slow.
+ *
+ * @since_tizen 3.0
+ *
+ * @remarks The default budget is 20 milliseconds. \n
+ *          A callback which runs longer is logged and counted, see telephony_get_noti_slow_callbacks(). \n
+ *          Every callback of a handle is invoked in turn, so a slow one delays the others.
+ *
+ * @param[in] handle  The handle to use the telephony API
+ * @param[in] budget_us The budget in microseconds, greater than @c 0
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ *
+ * @see telephony_get_noti_slow_callbacks()
+ */
+int telephony_set_noti_callback_budget(telephony_h handle, unsigned int budget_us);
+
+/**
+ * @brief Gets the callbacks which ran longer than the budget of the handle.
+ *
+ * @since_tizen 3.0
+ *
+ * @remarks The callbacks are returned in the order they were first found slow. \n
+ *          Up to #TELEPHONY_NOTI_SLOW_CALLBACKS_MAX distinct callbacks are tracked per handle.
+ *
+ * @param[in] handle  The handle to use the telephony API
+ * @param[out] callbacks The array receiving the slow callbacks
+ * @param[in] max The number of elements of @a callbacks
+ * @param[out] count The number of elements stored in @a callbacks
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ *
+ * @see telephony_set_noti_callback_budget()
+ */
+int telephony_get_noti_slow_callbacks(telephony_h handle,
+    telephony_noti_slow_callback_s *callbacks, unsigned int max, unsigned int *count);
+
+/**
+ * @brief Enables or disables the filtering of notifications whose value did not change.
+ *
+ * @since_tizen 3.0
+ *
+ * @remarks The filter is enabled by default. \n
+ *          It applies to the notifications carrying a value, such as #TELEPHONY_NOTI_NETWORK_CELLID
+ *          or #TELEPHONY_NOTI_SIM_STATUS: a notification with the same value as the previous one
+ *          of the same @a handle is not delivered. \n
+ *          Call status notifications are never filtered. \n
+ *          The next value after a callback is set, or after its #telephony_noti_policy_s dropped one,
+ *          is always delivered to it.
+ *
+ * @param[in] handle  The handle to use the telephony API
+ * @param[in] enable @c true to filter the unchanged values, @c false to deliver every notification
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ *
+ * @see telephony_get_noti_stats()
+ */
+int telephony_set_noti_filter(telephony_h handle, bool enable);
+
+/**
+ * @brief Gets the delivery counters of a notification since the handle was initialized.
+ *
+ * @since_tizen 3.0
+ *
+ * @remarks The counters sum up every callback, event queue and batch callback of @a noti_id on @a handle.
+ *
+ * @param[in] handle  The handle to use the telephony API
+ * @param[in] noti_id The notification ID
+ * @param[out] stats The delivery counters
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ *
+ * @see telephony_set_noti_cb_with_policy()
+ */
+int telephony_get_noti_stats(telephony_h handle, telephony_noti_e noti_id,
+    telephony_noti_stats_s *stats);
+
+/**
+ * @brief Enumeration for the classes of notifications queued for delivery.
+ * @since_tizen 3.0
+ */
+typedef enum {
+    TELEPHONY_NOTI_CLASS_STATUS, /**< Call, SIM and preferred voice subscription notifications */
+    TELEPHONY_NOTI_CLASS_NETWORK, /**< Network notifications */
+} telephony_noti_class_e;
+
+/**
+ * @brief Enumeration for what happens to a notification received while its queue is full.
+ * @since_tizen 3.0
+ */
+typedef enum {
+    TELEPHONY_NOTI_OVERFLOW_DROP_OLDEST, /**< The oldest pending notification of the class is dropped */
+    TELEPHONY_NOTI_OVERFLOW_NEVER_DROP, /**< The queue grows beyond its capacity and a warning is logged, no notification is dropped */
+} telephony_noti_overflow_e;
+
+/**
+ * @brief Definition for the max capacity of the queue of a notification class.
+ * @since_tizen 3.0
+ */
+#define TELEPHONY_NOTI_QUEUE_CAPACITY_MAX 1024
+
+/**
+ * @brief The structure type for the counters of the queue of a notification class.
+ * @since_tizen 3.0
+ */
+typedef struct {
+    unsigned int depth; /**< Number of notifications waiting to be delivered */
+    unsigned int high_water; /**< Highest depth since the handle was initialized */
+    unsigned int dropped; /**< Number of notifications dropped because the queue was full */
+} telephony_noti_queue_stats_s;
+
+/**
+ * @brief Sets the capacity and overflow policy of the queue of a notification class.
+ *
+ * @since_tizen 3.0
+ *
+ * @remarks Notifications wait in the queue of their class until the main loop delivers them. \n
+ *          By default, #TELEPHONY_NOTI_CLASS_STATUS holds 64 notifications and never drops any,
+ *          so no call or SIM status change is lost while the main loop is stalled. \n
+ *          A pending network notification is replaced by a later one of the same @a noti_id,
+ *          which is counted in @a suppressed of #telephony_noti_stats_s, so at most one per network
+ *          @a noti_id is pending. The default capacity of #TELEPHONY_NOTI_CLASS_NETWORK is 8, one per
+ *          network @a noti_id, so it only drops the oldest one with a smaller capacity. \n
+ *          Notifications already pending beyond a smaller drop-oldest capacity are dropped.
+ *
+ * @param[in] handle  The handle to use the telephony API
+ * @param[in] noti_class The notification class
+ * @param[in] capacity The number of notifications the queue holds, up to #TELEPHONY_NOTI_QUEUE_CAPACITY_MAX
+ * @param[in] overflow The policy applied once the queue is full
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ *
+ * @see telephony_get_noti_queue_stats()
+ */
+int telephony_set_noti_queue_policy(telephony_h handle, telephony_noti_class_e noti_class,
+    unsigned int capacity, telephony_noti_overflow_e overflow);
+
+/**
+ * @brief Gets the counters of the queue of a notification class.
+ *
+ * @since_tizen 3.0
+ *
+ * @param[in] handle  The handle to use the telephony API
+ * @param[in] noti_class The notification class
+ * @param[out] stats The queue counters
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ *
+ * @see telephony_set_noti_queue_policy()
+ */
+int telephony_get_noti_queue_stats(telephony_h handle, telephony_noti_class_e noti_class,
+    telephony_noti_queue_stats_s *stats);
+
+/**
+ * @brief Definition for the max length of the string data of an event.
+ * @since_tizen 3.0
+ */
+#define TELEPHONY_EVENT_STRING_LEN_MAX 64
+
+/**
+ * @brief Definition for the max number of events an event queue can hold.
+ * @since_tizen 3.0
+ */
+#define TELEPHONY_EVENT_QUEUE_CAPACITY_MAX 4096
+
+/**
+ * @brief The structure type for a notification stored as a value.
+ * @since_tizen 3.0
+ */
+typedef struct {
+    telephony_noti_e noti_id; /**< The notification ID */
+    telephony_h handle; /**< The handle which received the notification */
+    union {
+        int int_value; /**< Notification data of the noti_ids delivering an int or an enumeration */
+        unsigned int handle_id; /**< Notification data of the noti_ids delivering 'handle_id(unsigned int)' */
+        char string[TELEPHONY_EVENT_STRING_LEN_MAX + 1]; /**< Notification data of the noti_ids delivering a string, truncated if longer */
+    } data; /**< Notification data, as described in #telephony_noti_e */
+    unsigned long long timestamp; /**< Time the notification was received, in microseconds of the monotonic clock */
+} telephony_event_s;
+
+/**
+ * @brief The event queue handle.
+ * @since_tizen 3.0
+ */
+typedef struct _telephony_event_queue_s *telephony_event_queue_h;
+
+/**
+ * @brief Creates a queue receiving notifications as #telephony_event_s values, to be read with telephony_event_poll().
+ *
+ * @since_tizen 3.0
+ * @privlevel public
+ * @privilege %http://tizen.org/privilege/telephony
+ *
+ * @remarks The queue is meant for applications which do not run a main loop of their own:
+ *          its file descriptor becomes readable when events are pending and can be watched with poll() or epoll. \n
+ *          The notifications are still received by the main loop of the thread which called telephony_init(),
+ *          or by the dispatcher thread if telephony_init_with_dispatcher() was used. \n
+ *          Events which arrive while the queue is full are dropped. \n
+ *          @a queue must be destroyed with telephony_event_queue_destroy() before @a handle is deinitialized.
+ *
+ * @param[in] handle  The handle to use the telephony API
+ * @param[in] noti_ids The array of notification IDs to receive
+ * @param[in] count The number of elements in @a noti_ids
+ * @param[in] capacity The number of events the queue can hold, up to #TELEPHONY_EVENT_QUEUE_CAPACITY_MAX
+ * @param[out] queue The event queue handle
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_PERMISSION_DENIED Permission denied
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ * @retval #TELEPHONY_ERROR_OPERATION_FAILED  Operation failed
+ *
+ * @see telephony_event_queue_destroy()
+ * @see telephony_event_queue_get_fd()
+ * @see telephony_event_poll()
+ */
+int telephony_event_queue_create(telephony_h handle, const telephony_noti_e *noti_ids,
+    unsigned int count, unsigned int capacity, telephony_event_queue_h *queue);
+
+/**
+ * @brief Destroys an event queue, the events it still holds are discarded.
+ *
+ * @since_tizen 3.0
+ *
+ * @param[in] queue The event queue handle
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ *
+ * @see telephony_event_queue_create()
+ */
+int telephony_event_queue_destroy(telephony_event_queue_h queue);
+
+/**
+ * @brief Gets the file descriptor which becomes readable when the event queue holds events.
+ *
+ * @since_tizen 3.0
+ *
+ * @remarks The file descriptor is owned by @a queue, it must not be read or closed by the application. \n
+ *          It stays valid until telephony_event_queue_destroy() is called.
+ *
+ * @param[in] queue The event queue handle
+ * @param[out] fd The file descriptor
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ *
+ * @see telephony_event_poll()
+ */
+int telephony_event_queue_get_fd(telephony_event_queue_h queue, int *fd);
+
+/**
+ * @brief Moves the oldest pending events of an event queue to @a events, without blocking.
+ *
+ * @since_tizen 3.0
+ *
+ * @remarks Events are returned in the order they were received. \n
+ *          It must not be called by several threads at the same time for the same @a queue.
+ *
+ * @param[in] queue The event queue handle
+ * @param[out] events The array receiving the events
+ * @param[in] max The number of elements of @a events
+ * @param[out] count The number of events stored in @a events, @c 0 if none was pending
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ *
+ * @see telephony_event_queue_get_fd()
+ */
+int telephony_event_poll(telephony_event_queue_h queue, telephony_event_s *events,
+    unsigned int max, unsigned int *count);
+
+/**
+ * @brief Called with the notifications collected by a batch callback, in the order they were received.
+ * @since_tizen 3.0
+ * @remarks @a events is valid only inside the callback.
+ */
+typedef void (*telephony_noti_batch_cb)(telephony_h handle, const telephony_event_s *events,
+    size_t count, void *user_data);
+
+/**
+ * @brief The batch callback handle.
+ * @since_tizen 3.0
+ */
+typedef struct _telephony_noti_batch_s *telephony_noti_batch_h;
+
+/**
+ * @brief Sets a callback function to be invoked once for a burst of notifications.
+ *
+ * @since_tizen 3.0
+ * @privlevel public
+ * @privilege %http://tizen.org/privilege/telephony
+ *
+ * @remarks The notifications of @a noti_ids are collected instead of being delivered one by one. \n
+ *          If @a window_ms is @c 0, the callback is invoked once the main loop has no more pending event,
+ *          with every notification received in the meantime. \n
+ *          Otherwise, it is invoked @a window_ms milliseconds after the first notification of the batch. \n
+ *          The callback is invoked in the same thread as telephony_noti_cb(). \n
+ *          @a batch must be unset with telephony_unset_noti_batch_cb() before @a handle is deinitialized.
+ *
+ * @param[in] handle  The handle to use the telephony API
+ * @param[in] noti_ids The array of notification IDs to collect
+ * @param[in] count The number of elements in @a noti_ids
+ * @param[in] window_ms The time notifications are collected for, in milliseconds
+ * @param[in] cb The callback to be invoked with the collected notifications
+ * @param[in] user_data The user data passed to the callback function
+ * @param[out] batch The batch callback handle
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_PERMISSION_DENIED Permission denied
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ * @retval #TELEPHONY_ERROR_OPERATION_FAILED  Operation failed
+ *
+ * @post telephony_noti_batch_cb() will be invoked.
+ *
+ * @see telephony_unset_noti_batch_cb()
+ */
+int telephony_set_noti_batch_cb(telephony_h handle, const telephony_noti_e *noti_ids,
+    unsigned int count, unsigned int window_ms, telephony_noti_batch_cb cb, void *user_data,
+    telephony_noti_batch_h *batch);
+
+/**
+ * @brief Unsets a batch callback, the notifications not yet delivered are discarded.
+ *
+ * @since_tizen 3.0
+ *
+ * @remarks It can be called from telephony_noti_batch_cb().
+ *
+ * @param[in] batch The batch callback handle
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ *
+ * @see telephony_set_noti_batch_cb()
+ */
+int telephony_unset_noti_batch_cb(telephony_noti_batch_h batch);
+
 /**
  * @brief Acquires the list of available handles to use the telephony API.
  *
@@ -181,6 +759,37 @@ int telephony_unset_noti_cb(telephony_h handle, telephony_noti_e noti_id);
  */
 int telephony_init(telephony_handle_list_s *list);
 
+/**
+ * @brief Acquires the list of available handles, with notifications delivered on a library owned thread.
+ *
+ * @since_tizen 3.0
+ *
+ * @remarks Unlike telephony_init(), the handles do not depend on the main loop of the application:
+ *          the callbacks set with telephony_set_noti_cb() are invoked on a thread running its own main context,
+ *          shared by the handles of @a list. \n
+ *          Callbacks are invoked one at a time and in the order of the events. \n
+ *          Every telephony API may be called from any thread, including from inside a callback. \n
+ *          telephony_set_noti_cb(), telephony_unset_noti_cb() and telephony_deinit() wait for the dispatcher thread,
+ *          so they must not be called while holding a lock which a callback may also take. \n
+ *          No callback of the handles is invoked anymore once telephony_deinit() returns,
+ *          unless it is called from inside a callback.
+ *
+ * @param[out] list The list contains the number of
+ *                  available handles and array of handles
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ * @retval #TELEPHONY_ERROR_OPERATION_FAILED  Operation failed
+ *
+ * @see telephony_init()
+ * @see telephony_deinit()
+ */
+int telephony_init_with_dispatcher(telephony_handle_list_s *list);
+
 /**
  * @brief Deinitializes the telephony handle list.
  *
@@ -200,6 +809,99 @@ int telephony_init(telephony_handle_list_s *list);
  */
 int telephony_deinit(telephony_handle_list_s *list);
 
+/**
+ * @brief Definition for the min size of the ring of a notification recording in bytes.
+ * @since_tizen 3.0
+ */
+#define TELEPHONY_NOTI_RECORDER_SIZE_MIN 4096
+
+/**
+ * @brief Definition for the max size of the ring of a notification recording in bytes.
+ * @since_tizen 3.0
+ */
+#define TELEPHONY_NOTI_RECORDER_SIZE_MAX (64 * 1024 * 1024)
+
+/**
+ * @brief Starts recording the notifications received by every handle of the process.
+ *
+ * @since_tizen 3.0
+ *
+ * @remarks Each notification is stored with its event name, value, reception time and
+ *          the index of its handle in its #telephony_handle_list_s. \n
+ *          The file is memory mapped and holds a ring of @a size bytes: once it is full,
+ *          the oldest notifications are overwritten. \n
+ *          An existing file at @a path is replaced. \n
+ *          Only one recording can run at a time.
+ *
+ * @param[in] path The path of the recording file
+ * @param[in] size The size of the ring in bytes, from #TELEPHONY_NOTI_RECORDER_SIZE_MIN
+ *                 to #TELEPHONY_NOTI_RECORDER_SIZE_MAX
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter or recording already started
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ * @retval #TELEPHONY_ERROR_OPERATION_FAILED  The file cannot be created
+ *
+ * @see telephony_noti_recorder_stop()
+ * @see telephony_noti_replay()
+ */
+int telephony_noti_recorder_start(const char *path, unsigned int size);
+
+/**
+ * @brief Stops the recording of notifications and writes the file to storage.
+ *
+ * @since_tizen 3.0
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER No recording started
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ *
+ * @see telephony_noti_recorder_start()
+ */
+int telephony_noti_recorder_stop(void);
+
+/**
+ * @brief Starts delivering the notifications of a recording to the callbacks set on a handle list.
+ *
+ * @since_tizen 3.0
+ *
+ * @remarks Each notification goes to the handle of @a list at its recorded index, and is
+ *          skipped if there is none. \n
+ *          The function returns at once: each notification is delivered later, by the main
+ *          loop of the thread which initialized its handle, or by the dispatcher thread of the
+ *          handle if it was initialized with telephony_init_with_dispatcher(). \n
+ *          Replayed notifications go through the delivery queues in turn with live ones, and
+ *          the value filter, delivery policies and queue policies apply to them, but they do
+ *          not update the cached telephony state. \n
+ *          The recording is read at once, so it may be overwritten during the replay. \n
+ *          Starting a replay stops the one in progress, deinitializing a handle of @a list
+ *          stops it too.
+ *
+ * @param[in] list The handle list
+ * @param[in] path The path of a file written by telephony_noti_recorder_start()
+ * @param[in] realtime @c true to keep the recorded time between notifications,
+ *                     @c false to deliver them as fast as possible
+ * @param[out] count The number of notifications to be delivered
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ * @retval #TELEPHONY_ERROR_OPERATION_FAILED  The file is missing or corrupted
+ *
+ * @see telephony_noti_recorder_start()
+ */
+int telephony_noti_replay(telephony_handle_list_s *list, const char *path, bool realtime,
+    unsigned int *count);
+
 /**
  * @}
  */
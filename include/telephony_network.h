@@ -122,6 +122,42 @@ typedef enum {
 	TELEPHONY_NETWORK_DEFAULT_SUBS_SIM2 /**<  SIM 2 network **/
 } telephony_network_default_subs_e;
 
+/**
+ * @brief Definition for the max length of MCC (Mobile Country Code).
+ * @since_tizen 3.0
+ */
+#define TELEPHONY_NETWORK_MCC_LEN_MAX 3
+
+/**
+ * @brief Definition for the max length of MNC (Mobile Network Code).
+ * @since_tizen 3.0
+ */
+#define TELEPHONY_NETWORK_MNC_LEN_MAX 3
+
+/**
+ * @brief Definition for the max length of network name.
+ * @since_tizen 3.0
+ */
+#define TELEPHONY_NETWORK_NAME_LEN_MAX 128
+
+/**
+ * @brief The structure type for the snapshot of the current network.
+ * @since_tizen 3.0
+ */
+typedef struct {
+    int lac; /**< Location Area Code */
+    int cell_id; /**< Cell ID */
+    telephony_network_rssi_e rssi; /**< Received Signal Strength Indicator */
+    bool roaming_status; /**< true: Roaming, false: Not roaming */
+    char mcc[TELEPHONY_NETWORK_MCC_LEN_MAX + 1]; /**< Mobile Country Code */
+    char mnc[TELEPHONY_NETWORK_MNC_LEN_MAX + 1]; /**< Mobile Network Code */
+    char network_name[TELEPHONY_NETWORK_NAME_LEN_MAX + 1]; /**< Network name */
+    telephony_network_name_option_e network_name_option; /**< Network name option */
+    telephony_network_type_e network_type; /**< Network type */
+    telephony_network_ps_type_e ps_type; /**< Packet service type */
+    telephony_network_service_state_e service_state; /**< Network service state */
+} telephony_network_snapshot_s;
+
 /**
  * @brief Gets the LAC (Location Area Code) of the current network.
  *
@@ -280,6 +316,36 @@ int telephony_network_get_mcc(telephony_h handle, char **mcc);
  */
 int telephony_network_get_mnc(telephony_h handle, char **mnc);
 
+/**
+ * @brief Gets the MCC (Mobile Country Code) and the MNC (Mobile Network Code) of the current registered network.
+ *
+ * @since_tizen 3.0
+ * @privlevel public
+ * @privilege %http://tizen.org/privilege/telephony
+ *
+ * @remarks Both codes are taken from the same PLMN value and written into buffers owned by the caller.
+ *
+ * @param[in] handle The handle from telephony_init()
+ * @param[out] mcc The Mobile Country Code (three digits)
+ * @param[out] mnc The Mobile Network Code (two or three digits)
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_PERMISSION_DENIED Permission denied
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ * @retval #TELEPHONY_ERROR_OPERATION_FAILED  Operation failed
+ *
+ * @pre The Network service state must be #TELEPHONY_NETWORK_SERVICE_STATE_IN_SERVICE.
+ *
+ * @see telephony_network_get_mcc()
+ * @see telephony_network_get_mnc()
+ */
+int telephony_network_get_plmn(telephony_h handle,
+    char mcc[TELEPHONY_NETWORK_MCC_LEN_MAX + 1], char mnc[TELEPHONY_NETWORK_MNC_LEN_MAX + 1]);
+
 /**
  * @brief Gets the name of the current registered network.
  *
@@ -454,6 +520,175 @@ int telephony_network_get_default_data_subscription(telephony_h handle,
 int telephony_network_get_default_subscription(telephony_h handle,
 	telephony_network_default_subs_e *default_sub);
 
+/**
+ * @brief Gets all the information of the current network at once.
+ *
+ * @since_tizen 3.0
+ * @privlevel public
+ * @privilege %http://tizen.org/privilege/telephony
+ *
+ * @remarks All the fields are fetched with a single request to the telephony service,
+ *          so they are consistent with each other. \n
+ *          Fields which are not provided by the telephony service are set to 0 or unknown.
+ *
+ * @param[in] handle The handle from telephony_init()
+ * @param[out] snapshot The information of the current network
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_PERMISSION_DENIED Permission denied
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ * @retval #TELEPHONY_ERROR_OPERATION_FAILED  Operation failed
+ */
+int telephony_network_get_snapshot(telephony_h handle, telephony_network_snapshot_s *snapshot);
+
+/**
+ * @brief Gets the statistics of the network property cache.
+ *
+ * @since_tizen 3.0
+ *
+ * @remarks The network getters answer from an in-memory cache which is kept up to date
+ *          by the network property notifications. A miss means the value was fetched
+ *          from the telephony service.
+ *
+ * @param[in] handle The handle from telephony_init()
+ * @param[out] hit_count The number of reads answered from the cache
+ * @param[out] miss_count The number of reads fetched from the telephony service
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ * @retval #TELEPHONY_ERROR_OPERATION_FAILED  Operation failed
+ */
+int telephony_network_get_cache_stats(telephony_h handle,
+	unsigned int *hit_count, unsigned int *miss_count);
+
+/**
+ * @brief Definition for the max number of changes a network history can hold.
+ * @since_tizen 3.0
+ */
+#define TELEPHONY_NETWORK_HISTORY_CAPACITY_MAX 65536
+
+/**
+ * @brief Called for each change of a network history.
+ * @since_tizen 3.0
+ *
+ * @param[in] timestamp The time of the change, in microseconds of the monotonic clock
+ * @param[in] snapshot The network state right after the change
+ * @param[in] user_data The user data passed to telephony_network_history_foreach()
+ *
+ * @return @c true to continue with the next change, otherwise @c false to stop
+ *
+ * @see telephony_network_history_foreach()
+ */
+typedef bool (*telephony_network_history_cb)(unsigned long long timestamp,
+	const telephony_network_snapshot_s *snapshot, void *user_data);
+
+/**
+ * @brief Starts recording the changes of the network state of a handle.
+ *
+ * @since_tizen 3.0
+ *
+ * @remarks The history records the cell ID, LAC, PLMN, service state, PS type and RSSI,
+ *          as the network property notifications update them. \n
+ *          It holds the last @a capacity changes: older ones are folded into the state
+ *          the history starts from. \n
+ *          The history starts from the values known to the handle. Call
+ *          telephony_network_get_snapshot() after enabling it to start from every value. \n
+ *          Enabling the history again discards it and starts a new one.
+ *
+ * @param[in] handle The handle from telephony_init()
+ * @param[in] capacity The number of changes to keep, up to #TELEPHONY_NETWORK_HISTORY_CAPACITY_MAX
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ *
+ * @see telephony_network_history_disable()
+ * @see telephony_network_history_at()
+ */
+int telephony_network_history_enable(telephony_h handle, unsigned int capacity);
+
+/**
+ * @brief Stops recording the changes of the network state and discards the history.
+ *
+ * @since_tizen 3.0
+ *
+ * @param[in] handle The handle from telephony_init()
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ *
+ * @see telephony_network_history_enable()
+ */
+int telephony_network_history_disable(telephony_h handle);
+
+/**
+ * @brief Gets the network state of a handle at a point in time.
+ *
+ * @since_tizen 3.0
+ *
+ * @remarks Only @a cell_id, @a lac, @a mcc, @a mnc, @a rssi, @a network_type,
+ *          @a service_state and @a ps_type of @a snapshot are filled, the other
+ *          members are zero. Values unknown at @a timestamp are zero or unknown as well.
+ *
+ * @param[in] handle The handle from telephony_init()
+ * @param[in] timestamp The time, in microseconds of the monotonic clock
+ * @param[out] snapshot The network state at @a timestamp
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter, history not enabled or
+ *                                            @a timestamp before its start
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ *
+ * @see telephony_network_history_enable()
+ * @see telephony_network_history_foreach()
+ */
+int telephony_network_history_at(telephony_h handle, unsigned long long timestamp,
+	telephony_network_snapshot_s *snapshot);
+
+/**
+ * @brief Calls a callback for each change of the network state of a handle in a time range.
+ *
+ * @since_tizen 3.0
+ *
+ * @remarks The callback is called synchronously, oldest change first, with the
+ *          members of the snapshot described in telephony_network_history_at().
+ *
+ * @param[in] handle The handle from telephony_init()
+ * @param[in] from The start of the range, in microseconds of the monotonic clock
+ * @param[in] to The end of the range, included
+ * @param[in] callback The callback to call for each change
+ * @param[in] user_data The user data passed to @a callback
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter or history not enabled
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ *
+ * @see telephony_network_history_at()
+ */
+int telephony_network_history_foreach(telephony_h handle, unsigned long long from,
+	unsigned long long to, telephony_network_history_cb callback, void *user_data);
+
 /**
  * @}
  */
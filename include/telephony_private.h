@@ -22,6 +22,8 @@
 #include <system_info.h>
 #include "telephony_common.h"
 #include "telephony_call.h"
+#include "telephony_network.h"
+#include "telephony_sim.h"
 
 #define TELEPHONY_FEATURE	"http://tizen.org/feature/network.telephony"
 
@@ -37,16 +39,9 @@
 	}
 
 #define CHECK_TELEPHONY_SUPPORTED(feature_name) { \
-	bool telephony_supported = FALSE; \
-	if (!system_info_get_platform_bool(feature_name, &telephony_supported)) { \
-		if (telephony_supported == FALSE) { \
-			LOGE("telephony feature is disabled"); \
-			return TELEPHONY_ERROR_NOT_SUPPORTED; \
-		} \
-	} else { \
-		LOGE("Error - Feature getting from System Info"); \
-		return TELEPHONY_ERROR_OPERATION_FAILED; \
-	} \
+	int feature_ret = _telephony_check_feature_supported(feature_name); \
+	if (feature_ret != TELEPHONY_ERROR_NONE) \
+		return feature_ret; \
 }
 
 /**
@@ -55,9 +50,190 @@
  */
 #define TELEPHONY_CALL_NUMBER_LEN_MAX 82
 
+/*
+ * Network properties kept in the per-handle network cache
+ */
+typedef enum {
+	NETWORK_PROP_LAC,
+	NETWORK_PROP_CELLID,
+	NETWORK_PROP_SIGNALSTRENGTH_LEVEL,
+	NETWORK_PROP_ROAMING_STATUS,
+	NETWORK_PROP_PLMN,
+	NETWORK_PROP_NETWORK_NAME,
+	NETWORK_PROP_NAME_OPTION,
+	NETWORK_PROP_SERVICE_TYPE,
+	NETWORK_PROP_PS_TYPE,
+	NETWORK_PROP_MAX
+} telephony_network_prop_e;
+
+/* Length of a PLMN, MCC followed by MNC */
+#define NETWORK_PLMN_LEN_MAX (TELEPHONY_NETWORK_MCC_LEN_MAX + TELEPHONY_NETWORK_MNC_LEN_MAX)
+
+/* Values of the network properties recorded by the history at some point in time */
 typedef struct {
-	GSList *evt_list;
+	guint valid; /* Bitmask of known telephony_network_prop_e */
+	int int_value[NETWORK_PROP_MAX];
+	char plmn[NETWORK_PLMN_LEN_MAX + 1];
+} telephony_network_history_state;
+
+/* A change of one network property */
+typedef struct {
+	gint64 timestamp; /* Monotonic time of the change */
+	telephony_network_prop_e prop;
+	union {
+		int int_value;
+		char plmn[NETWORK_PLMN_LEN_MAX + 1];
+	} value;
+} telephony_network_history_delta;
+
+/*
+ * Ring of the last changes of the network properties, oldest first,
+ * see telephony_network_history_enable()
+ */
+typedef struct {
+	telephony_network_history_delta *deltas; /* NULL while disabled */
+	guint capacity;
+	guint head; /* Oldest delta */
+	guint count;
+	gint64 base_timestamp; /* Start of the history */
+	telephony_network_history_state base; /* State before the oldest delta */
+	telephony_network_history_state current; /* State after the newest delta */
+} telephony_network_history;
+
+/*
+ * In-memory copy of the network properties of a handle.
+ * It is seeded by the first read of each property, kept up to date by the
+ * PropertiesChanged signal of the network interface and dropped when the
+ * telephony daemon goes away.
+ */
+typedef struct {
+	GMutex mutex;
+	guint valid; /* Bitmask of cached telephony_network_prop_e */
+	guint generation; /* Bumped on every update, protects seeding against races */
+	int int_value[NETWORK_PROP_MAX];
+	char *str_value[NETWORK_PROP_MAX];
+	char plmn_mcc[TELEPHONY_NETWORK_MCC_LEN_MAX + 1]; /* Parsed from NETWORK_PROP_PLMN */
+	char plmn_mnc[TELEPHONY_NETWORK_MNC_LEN_MAX + 1];
+	guint prop_changed_id;
+	unsigned int hit_count;
+	unsigned int miss_count;
+	telephony_network_history history;
+} telephony_network_cache;
+
+/*
+ * SIM values which cannot change while the same card stays inserted
+ */
+typedef enum {
+	SIM_IDENTITY_ICC_ID = 1 << 0,
+	SIM_IDENTITY_IMSI = 1 << 1,
+	SIM_IDENTITY_SPN = 1 << 2,
+	SIM_IDENTITY_MSISDN = 1 << 3,
+	SIM_IDENTITY_APP_LIST = 1 << 4
+} telephony_sim_identity_e;
+
+/*
+ * SIM card status of a handle, tracked from the SIM status notification
+ * so that SIM getters do not have to ask the telephony daemon first.
+ * The identity values are filled on first access once the card is in the
+ * SIM_INIT_COMPLETED state, and dropped on every status transition or when
+ * its card changed flag flips.
+ */
+typedef struct {
+	GMutex mutex;
+	gboolean status_valid;
+	int status; /* TelSimCardStatus_t */
+	guint generation;
+	guint status_changed_id;
+
+	gboolean card_changed_valid;
+	int card_changed;
+	guint identity_valid; /* Bitmask of telephony_sim_identity_e */
+	char *icc_id;
+	char *spn;
+	char *msisdn;
+	telephony_sim_imsi_s imsi;
+	unsigned int app_list;
+} telephony_sim_cache;
+
+/*
+ * Calls of a handle, seeded from the daemon on first use and then kept up
+ * to date from the call status signals, so that the call list and the call
+ * states can be served without any IPC.
+ */
+typedef struct {
+	GMutex mutex;
+	gboolean valid; /* Seeded and not invalidated since */
+	gboolean dirty; /* A change was seen which the signals do not fully describe */
+	guint generation; /* Bumped on every update, protects seeding against races */
+	GArray *calls; /* Array of telephony_call_info_s */
+	guint call_signal_id;
+} telephony_call_table;
+
+/* Time a callback may take before it is reported as slow, in microseconds */
+#define TELEPHONY_NOTI_CALLBACK_BUDGET_DEFAULT 20000
+
+/* Size of the tables indexed by telephony_noti_e */
+#define TELEPHONY_NOTI_ID_MAX (TELEPHONY_NOTI_CALL_PREFERRED_VOICE_SUBSCRIPTION + 1)
+
+/* Delivery counters of one noti_id of a handle, see telephony_get_noti_stats() */
+typedef struct {
+	gint delivered;
+	gint suppressed;
+	gint filtered;
+	gint slow;
+	gint latency[TELEPHONY_NOTI_HISTOGRAM_BUCKETS];
+	gint duration[TELEPHONY_NOTI_HISTOGRAM_BUCKETS];
+} telephony_noti_counters;
+
+/* Value last delivered for a property notification, see telephony_set_noti_filter() */
+typedef struct {
+	gboolean valid;
+	int int_value;
+	char *string;
+} telephony_noti_last_value;
+
+/* Delivery priorities of the notifications of a handle, same order as telephony_noti_class_e */
+typedef enum {
+	NOTI_LANE_HIGH, /* Call and SIM events */
+	NOTI_LANE_LOW, /* Network properties, coalesced */
+	NOTI_LANE_MAX
+} telephony_noti_lane_e;
+
+/* Notifications of one priority waiting to be delivered, see telephony_common.c */
+typedef struct {
+	telephony_noti_lane_e lane_id;
+	struct telephony_data *handle_data;
+	GQueue events; /* Oldest first */
+	GSource *source; /* Delivers events, NULL while empty */
+	guint capacity;
+	telephony_noti_overflow_e overflow;
+	guint high_water;
+	guint dropped;
+	gboolean overflowed; /* Already warned about growing beyond capacity since the lane was last empty */
+} telephony_noti_lane;
+
+/* Notification thread of a handle, see telephony_dispatcher.c */
+typedef struct _telephony_dispatcher telephony_dispatcher;
+
+typedef struct telephony_data {
+	GSList *noti_subs[TELEPHONY_NOTI_ID_MAX]; /* Subscriptions of each noti_id in registration order */
+	GMutex noti_mutex; /* Protects noti_subs and noti_events */
+	GHashTable *noti_events; /* TAPI event name -> its subscribers, see telephony_common.c */
+	telephony_noti_counters noti_stats[TELEPHONY_NOTI_ID_MAX];
+	telephony_noti_last_value *noti_last_values; /* Indexed like the TAPI event table, protected by noti_mutex */
+	gint noti_filter_disabled; /* Repeated property values are delivered too */
+	telephony_noti_lane noti_lanes[NOTI_LANE_MAX]; /* Protected by noti_mutex */
+	gint noti_callback_budget; /* In microseconds, see telephony_set_noti_callback_budget() */
+	telephony_noti_slow_callback_s noti_slow_callbacks[TELEPHONY_NOTI_SLOW_CALLBACKS_MAX]; /* Protected by noti_mutex */
+	guint noti_slow_callback_count;
 	struct tapi_handle *tapi_h;
+	guint name_watch_id;
+	telephony_network_cache network_cache;
+	telephony_sim_cache sim_cache;
+	telephony_call_table call_table;
+	telephony_dispatcher *dispatcher; /* NULL when notifications use the default main context */
+	GMainContext *context; /* Where notifications are dispatched: the one of the dispatcher, or the thread-default one of telephony_init() */
+	guint handle_index; /* Position in its telephony_handle_list_s */
 } telephony_data;
 
 /*
@@ -89,4 +265,115 @@ typedef struct {
 	bool conference_status; /**< true: Conference call, false: Single call */
 } telephony_call_info_s;
 
+/* Type of the notification data */
+typedef enum {
+	EVT_PAYLOAD_INT,
+	EVT_PAYLOAD_HANDLE_ID,
+	EVT_PAYLOAD_STRING
+} telephony_evt_payload_type_e;
+
+/*
+ * Returns TELEPHONY_ERROR_NONE if the feature is supported.
+ * The System Info lookup is done only once per process and the result is
+ * shared by every API, see CHECK_TELEPHONY_SUPPORTED().
+ */
+int _telephony_check_feature_supported(const char *feature_name);
+
+gboolean _telephony_variant_get_int(GVariant *value, int *result);
+
+/*
+ * Delivers the call status notification evt_id of call_id to the
+ * subscribers of the handle, see telephony_common.c
+ */
+void _telephony_noti_dispatch_call_status(telephony_data *data,
+	const char *evt_id, unsigned int call_id);
+
+/* Event queues, see telephony_event_queue.c */
+telephony_event_queue_h _telephony_event_queue_ref(telephony_event_queue_h queue);
+void _telephony_event_queue_unref(telephony_event_queue_h queue);
+/* Called by the thread dispatching the notifications of the handle only */
+void _telephony_event_queue_push(telephony_event_queue_h queue, const telephony_event_s *event);
+/* Batch callbacks, see telephony_noti_batch.c */
+telephony_noti_batch_h _telephony_noti_batch_ref(telephony_noti_batch_h batch);
+void _telephony_noti_batch_unref(telephony_noti_batch_h batch);
+/* Called by the thread dispatching the notifications of the handle only */
+void _telephony_noti_batch_append(telephony_noti_batch_h batch, const telephony_event_s *event);
+
+/*
+ * Where a subscription delivers telephony_event_s values instead of calling
+ * a telephony_noti_cb, exactly one member is set
+ */
+typedef struct {
+	telephony_event_queue_h queue;
+	telephony_noti_batch_h batch;
+} telephony_noti_sink;
+
+/*
+ * An event of on_signal_callback as stored by the notification recorder,
+ * strings are only valid during the call they are passed to
+ */
+typedef struct {
+	gint64 timestamp; /* Monotonic time the event was received */
+	guint handle_index; /* Of the handle in its telephony_handle_list_s */
+	const char *evt_id; /* TAPI event name */
+	gint type; /* A telephony_evt_payload_type_e */
+	gint value; /* Integer value or call handle ID */
+	gint call_state; /* For call status events */
+	const char *string; /* For string payloads, NULL otherwise */
+} telephony_noti_record;
+
+/* Notification recorder, see telephony_noti_recorder.c */
+gboolean _telephony_noti_recorder_is_active(void);
+void _telephony_noti_recorder_append(const telephony_noti_record *record);
+/* Queues a recorded event for delivery to the subscribers of the handle as if it was just received */
+void _telephony_noti_replay_record(telephony_data *data, const telephony_noti_record *record);
+/* Stops the replay in progress if it delivers to the handle */
+void _telephony_noti_replay_cancel(telephony_data *data);
+
+/* Subscriptions delivering to a sink, see telephony_common.c */
+int _telephony_noti_subscribe_sink(telephony_data *data, const telephony_noti_e *noti_ids,
+	unsigned int count, const telephony_noti_sink *sink);
+/* Removes every subscription of the queue or of the batch of sink */
+void _telephony_noti_unsubscribe_sink(telephony_data *data, const telephony_noti_sink *sink);
+
+/* Network property cache, see telephony_network.c */
+void _telephony_network_cache_init(telephony_data *data);
+void _telephony_network_cache_deinit(telephony_data *data);
+void _telephony_network_cache_invalidate(telephony_data *data);
+
+/* SIM status cache, see telephony_sim.c */
+void _telephony_sim_cache_init(telephony_data *data);
+void _telephony_sim_cache_deinit(telephony_data *data);
+void _telephony_sim_cache_invalidate(telephony_data *data);
+
+/* Call table, see telephony_call.c */
+void _telephony_call_table_init(telephony_data *data);
+void _telephony_call_table_deinit(telephony_data *data);
+void _telephony_call_table_invalidate(telephony_data *data);
+void _telephony_call_table_seed(telephony_data *data);
+/*
+ * Applies the call status notification evt_id of call_id to the call table
+ * and gives the resulting state of the calls of the same type, without IPC.
+ */
+int _telephony_call_table_get_state_for_event(telephony_data *data,
+	const char *evt_id, unsigned int call_id, telephony_call_state_e *call_state);
+
+/* Dispatcher thread, see telephony_dispatcher.c */
+typedef int (*telephony_dispatch_func)(telephony_data *data, gpointer user_data);
+telephony_dispatcher *_telephony_dispatcher_new(void);
+telephony_dispatcher *_telephony_dispatcher_ref(telephony_dispatcher *dispatcher);
+void _telephony_dispatcher_unref(telephony_dispatcher *dispatcher);
+GMainContext *_telephony_dispatcher_get_context(telephony_dispatcher *dispatcher);
+/*
+ * Runs func on the dispatcher thread of the handle and waits for its result.
+ * It is called directly when the handle has no dispatcher or when the caller
+ * already is the dispatcher thread.
+ */
+int _telephony_dispatcher_call(telephony_data *data,
+	telephony_dispatch_func func, gpointer user_data);
+
+/* Subscriptions of a handle, see telephony_common.c */
+void _telephony_noti_registry_init(telephony_data *data);
+void _telephony_noti_registry_deinit(telephony_data *data);
+
 #endif /* __CAPI_TELEPHONY_PRIVATE_H__ */
@@ -57,6 +57,41 @@ typedef enum {
 	TELEPHONY_SIM_APP_TYPE_ISIM = 0x08, /**< ISIM Application */
 } telephony_sim_application_type_e;
 
+/**
+ * @brief Definition for the max length of MCC (Mobile Country Code) of the SIM.
+ * @since_tizen 3.0
+ */
+#define TELEPHONY_SIM_MCC_LEN_MAX 3
+
+/**
+ * @brief Definition for the max length of MNC (Mobile Network Code) of the SIM.
+ * @since_tizen 3.0
+ */
+#define TELEPHONY_SIM_MNC_LEN_MAX 3
+
+/**
+ * @brief Definition for the max length of MSIN (Mobile Subscription Identification Number).
+ * @since_tizen 3.0
+ */
+#define TELEPHONY_SIM_MSIN_LEN_MAX 10
+
+/**
+ * @brief Definition for the length of the subscriber ID (hexadecimal SHA-256 digest).
+ * @since_tizen 3.0
+ */
+#define TELEPHONY_SIM_SUBSCRIBER_ID_LEN 64
+
+/**
+ * @brief The structure type for the IMSI (International Mobile Subscriber Identity) of the SIM.
+ * @since_tizen 3.0
+ */
+typedef struct {
+	char mcc[TELEPHONY_SIM_MCC_LEN_MAX + 1]; /**< Mobile Country Code */
+	char mnc[TELEPHONY_SIM_MNC_LEN_MAX + 1]; /**< Mobile Network Code */
+	char msin[TELEPHONY_SIM_MSIN_LEN_MAX + 1]; /**< Mobile Subscription Identification Number */
+	char subscriber_id[TELEPHONY_SIM_SUBSCRIBER_ID_LEN + 1]; /**< Subscriber ID, same as telephony_sim_get_subscriber_id() */
+} telephony_sim_imsi_s;
+
 
 /**
  * @brief Gets the Integrated Circuit Card IDentification (ICC-ID).
@@ -305,6 +340,38 @@ int telephony_sim_get_subscriber_number(telephony_h handle, char **subscriber_nu
  */
 int telephony_sim_get_subscriber_id(telephony_h handle, char **subscriber_id);
 
+/**
+ * @brief Gets the IMSI (International Mobile Subscriber Identity) information of the SIM.
+ * @details This function gets the MCC, MNC, MSIN and the subscriber ID at once.
+ *
+ * @since_tizen 3.0
+ * @privlevel public
+ * @privilege %http://tizen.org/privilege/telephony
+ *
+ * @remarks All the fields are taken from a single IMSI read, so they always belong to the same SIM card.
+ *
+ * @param[in] handle The handle from telephony_init()
+ * @param[out] imsi_info The IMSI information of the SIM
+ *
+ * @return @c 0 on success,
+ *         otherwise a negative error value
+ *
+ * @retval #TELEPHONY_ERROR_NONE              Successful
+ * @retval #TELEPHONY_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #TELEPHONY_ERROR_PERMISSION_DENIED Permission denied
+ * @retval #TELEPHONY_ERROR_NOT_SUPPORTED     Not supported
+ * @retval #TELEPHONY_ERROR_OPERATION_FAILED  Operation failed
+ * @retval #TELEPHONY_ERROR_SIM_NOT_AVAILABLE SIM is not available
+ *
+ * @pre The SIM state must be #TELEPHONY_SIM_STATE_AVAILABLE.
+ *
+ * @see telephony_sim_get_state()
+ * @see telephony_sim_get_operator()
+ * @see telephony_sim_get_msin()
+ * @see telephony_sim_get_subscriber_id()
+ */
+int telephony_sim_get_imsi_info(telephony_h handle, telephony_sim_imsi_s *imsi_info);
+
 /**
  * @}
  */
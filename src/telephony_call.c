@@ -18,6 +18,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <glib.h>
+#include <gio/gio.h>
 #include <dlog.h>
 
 #include <tapi_common.h>
@@ -27,6 +28,9 @@
 #include "telephony_call.h"
 #include "telephony_private.h"
 
+/* Enough for a multi-party call plus a waiting call without growing */
+#define CALL_TABLE_RESERVED_SIZE 8
+
 static void _mapping_call_state(TelCallStates_t tapi_call_state, telephony_call_state_e *call_state)
 {
 	switch (tapi_call_state) {
@@ -77,35 +81,13 @@ static void _mapping_call_status(TelCallStates_t tapi_call_state,
 	}
 }
 
-static void _voice_call_get_state_cb(TelCallStatus_t *tapi_status, void *user_data)
-{
-	telephony_call_state_e *call_state = user_data;
-
-	if (tapi_status->CallType != TAPI_CALL_TYPE_VOICE
-			&& tapi_status->CallType != TAPI_CALL_TYPE_E911)
-		return;
-
-	_mapping_call_state(tapi_status->CallState, call_state);
-}
-
-static void _video_call_get_state_cb(TelCallStatus_t *tapi_status, void *user_data)
-{
-	telephony_call_state_e *call_state = user_data;
-
-	if (tapi_status->CallType != TAPI_CALL_TYPE_DATA)
-		return;
-
-	_mapping_call_state(tapi_status->CallState, call_state);
-}
-
 static void _get_call_status_cb(TelCallStatus_t *status, void *user_data)
 {
-	GSList **list = user_data;
-	telephony_call_info_s *call_info;
+	GArray *calls = user_data;
+	telephony_call_info_s info;
+	telephony_call_info_s *call_info = &info;
 
-	call_info = g_malloc0(sizeof(telephony_call_info_s));
-	if (!call_info)
-		return;
+	memset(call_info, 0, sizeof(telephony_call_info_s));
 	call_info->id = status->CallHandle;
 	call_info->type = status->CallType;
 	call_info->direction = status->bMoCall ? TELEPHONY_CALL_DIRECTION_MO : TELEPHONY_CALL_DIRECTION_MT;
@@ -125,7 +107,336 @@ static void _get_call_status_cb(TelCallStatus_t *status, void *user_data)
 		call_info->status == TELEPHONY_CALL_STATUS_INCOMING ? "INCOMING" : "UNKNOWN",
 		call_info->direction == TELEPHONY_CALL_DIRECTION_MO ? "MO" : "MT",
 		call_info->conference_status ? "TRUE" : "FALSE");
-	*list = g_slist_append(*list, call_info);
+	g_array_append_val(calls, info);
+}
+
+/* Call status signals of the call interface, see _on_call_signal() */
+static const struct {
+	const char *noti;
+	telephony_call_type_e type;
+	telephony_call_status_e status;
+} call_status_noti_tbl[] = {
+	{ TAPI_NOTI_VOICE_CALL_STATUS_IDLE, TELEPHONY_CALL_TYPE_VOICE, TELEPHONY_CALL_STATUS_IDLE },
+	{ TAPI_NOTI_VOICE_CALL_STATUS_ACTIVE, TELEPHONY_CALL_TYPE_VOICE, TELEPHONY_CALL_STATUS_ACTIVE },
+	{ TAPI_NOTI_VOICE_CALL_STATUS_HELD, TELEPHONY_CALL_TYPE_VOICE, TELEPHONY_CALL_STATUS_HELD },
+	{ TAPI_NOTI_VOICE_CALL_STATUS_DIALING, TELEPHONY_CALL_TYPE_VOICE, TELEPHONY_CALL_STATUS_DIALING },
+	{ TAPI_NOTI_VOICE_CALL_STATUS_ALERT, TELEPHONY_CALL_TYPE_VOICE, TELEPHONY_CALL_STATUS_ALERTING },
+	{ TAPI_NOTI_VOICE_CALL_STATUS_INCOMING, TELEPHONY_CALL_TYPE_VOICE, TELEPHONY_CALL_STATUS_INCOMING },
+	{ TAPI_NOTI_VIDEO_CALL_STATUS_IDLE, TELEPHONY_CALL_TYPE_VIDEO, TELEPHONY_CALL_STATUS_IDLE },
+	{ TAPI_NOTI_VIDEO_CALL_STATUS_ACTIVE, TELEPHONY_CALL_TYPE_VIDEO, TELEPHONY_CALL_STATUS_ACTIVE },
+	{ TAPI_NOTI_VIDEO_CALL_STATUS_DIALING, TELEPHONY_CALL_TYPE_VIDEO, TELEPHONY_CALL_STATUS_DIALING },
+	{ TAPI_NOTI_VIDEO_CALL_STATUS_ALERT, TELEPHONY_CALL_TYPE_VIDEO, TELEPHONY_CALL_STATUS_ALERTING },
+	{ TAPI_NOTI_VIDEO_CALL_STATUS_INCOMING, TELEPHONY_CALL_TYPE_VIDEO, TELEPHONY_CALL_STATUS_INCOMING }
+};
+
+static int _find_call_status_noti(const gchar *interface_name, const gchar *signal_name)
+{
+	int i;
+	int count = sizeof(call_status_noti_tbl) / sizeof(call_status_noti_tbl[0]);
+
+	/* TAPI notification names are "<dbus interface>:<dbus signal>" */
+	for (i = 0; i < count; i++) {
+		const char *member = strchr(call_status_noti_tbl[i].noti, ':');
+
+		if (member && !g_strcmp0(member + 1, signal_name)
+				&& !strncmp(call_status_noti_tbl[i].noti, interface_name,
+					member - call_status_noti_tbl[i].noti))
+			return i;
+	}
+
+	return -1;
+}
+
+/*
+ * The call handle is the first argument of every call status signal.
+ * Newer daemons send the incoming call information as a dictionary instead,
+ * in which case the number comes with it.
+ */
+static gboolean _call_signal_get_id(GVariant *parameters, unsigned int *id,
+	char *number, gsize number_len)
+{
+	GVariant *value;
+	gboolean found = FALSE;
+	const char *str = NULL;
+	int call_id;
+
+	if (g_variant_n_children(parameters) == 0)
+		return FALSE;
+
+	value = g_variant_get_child_value(parameters, 0);
+	if (_telephony_variant_get_int(value, &call_id)) {
+		found = TRUE;
+	} else if (g_variant_is_of_type(value, G_VARIANT_TYPE_VARDICT)) {
+		found = g_variant_lookup(value, "call_id", "i", &call_id);
+		if (found && g_variant_lookup(value, "number", "&s", &str))
+			g_strlcpy(number, str, number_len);
+	}
+	g_variant_unref(value);
+
+	if (found)
+		*id = (unsigned int)call_id;
+
+	return found;
+}
+
+/* Must be called with table->mutex held */
+static void _call_table_update(telephony_call_table *table, unsigned int id,
+	telephony_call_type_e type, telephony_call_status_e status, const char *number)
+{
+	telephony_call_info_s *call_info = NULL;
+	guint i;
+
+	for (i = 0; i < table->calls->len; i++) {
+		if (g_array_index(table->calls, telephony_call_info_s, i).id == id) {
+			call_info = &g_array_index(table->calls, telephony_call_info_s, i);
+			break;
+		}
+	}
+
+	if (status == TELEPHONY_CALL_STATUS_IDLE) {
+		if (call_info)
+			g_array_remove_index(table->calls, i);
+		/* A conference can not remain with a single call */
+		if (table->calls->len == 1)
+			g_array_index(table->calls, telephony_call_info_s, 0).conference_status = FALSE;
+		return;
+	}
+
+	if (call_info == NULL) {
+		telephony_call_info_s info;
+
+		memset(&info, 0, sizeof(telephony_call_info_s));
+		info.id = id;
+		info.type = type;
+		if (status == TELEPHONY_CALL_STATUS_INCOMING) {
+			info.direction = TELEPHONY_CALL_DIRECTION_MT;
+		} else if (status == TELEPHONY_CALL_STATUS_DIALING) {
+			info.direction = TELEPHONY_CALL_DIRECTION_MO;
+		} else {
+			/* The call has been missed from the start, its direction is unknown */
+			table->dirty = TRUE;
+		}
+		if (number[0] != '\0')
+			g_strlcpy(info.number, number, sizeof(info.number));
+		else
+			table->dirty = TRUE;
+		g_array_append_val(table->calls, info);
+		call_info = &g_array_index(table->calls, telephony_call_info_s, table->calls->len - 1);
+	}
+
+	call_info->status = status;
+}
+
+static void _on_call_signal(GDBusConnection *connection,
+	const gchar *sender_name, const gchar *object_path,
+	const gchar *interface_name, const gchar *signal_name,
+	GVariant *parameters, gpointer user_data)
+{
+	telephony_call_table *table = &((telephony_data *)user_data)->call_table;
+	char number[TELEPHONY_CALL_NUMBER_LEN_MAX + 1] = "";
+	unsigned int id = 0;
+	int idx;
+
+	idx = _find_call_status_noti(interface_name, signal_name);
+	if (idx >= 0 && !_call_signal_get_id(parameters, &id, number, sizeof(number))) {
+		LOGE("Unexpected [%s] signature [%s]", signal_name,
+			g_variant_get_type_string(parameters));
+		idx = -1;
+	}
+
+	g_mutex_lock(&table->mutex);
+	table->generation++;
+	if (idx >= 0) {
+		/* Tracked even before seeding, for the deprecated call state notifications */
+		_call_table_update(table, id, call_status_noti_tbl[idx].type,
+			call_status_noti_tbl[idx].status, number);
+	} else if (table->valid) {
+		if (table->calls->len > 1) {
+			/*
+			 * Other call signals (join, split, transfer, ...) may change
+			 * the conference status, which status signals do not carry
+			 */
+			table->dirty = TRUE;
+		}
+	}
+	g_mutex_unlock(&table->mutex);
+
+	/* The table is up to date before the application hears about the call */
+	if (idx >= 0)
+		_telephony_noti_dispatch_call_status(user_data, call_status_noti_tbl[idx].noti, id);
+}
+
+void _telephony_call_table_init(telephony_data *data)
+{
+	telephony_call_table *table = &data->call_table;
+
+	g_mutex_init(&table->mutex);
+	table->calls = g_array_sized_new(FALSE, TRUE, sizeof(telephony_call_info_s), CALL_TABLE_RESERVED_SIZE);
+
+	/* One match rule for every signal of the call interface */
+	table->call_signal_id = g_dbus_connection_signal_subscribe(
+		data->tapi_h->dbus_connection, DBUS_TELEPHONY_SERVICE,
+		DBUS_TELEPHONY_CALL_INTERFACE, NULL, data->tapi_h->path, NULL,
+		G_DBUS_SIGNAL_FLAGS_NONE, _on_call_signal, data, NULL);
+	if (table->call_signal_id == 0)
+		LOGE("Call table is disabled");
+}
+
+void _telephony_call_table_invalidate(telephony_data *data)
+{
+	telephony_call_table *table = &data->call_table;
+
+	g_mutex_lock(&table->mutex);
+	table->valid = FALSE;
+	table->dirty = FALSE;
+	table->generation++;
+	g_array_set_size(table->calls, 0);
+	g_mutex_unlock(&table->mutex);
+}
+
+void _telephony_call_table_deinit(telephony_data *data)
+{
+	telephony_call_table *table = &data->call_table;
+
+	if (table->call_signal_id) {
+		g_dbus_connection_signal_unsubscribe(data->tapi_h->dbus_connection,
+			table->call_signal_id);
+		table->call_signal_id = 0;
+	}
+	_telephony_call_table_invalidate(data);
+	g_array_free(table->calls, TRUE);
+	table->calls = NULL;
+	g_mutex_clear(&table->mutex);
+}
+
+/*
+ * Copies the calls of the handle into calls, asking the daemon only when
+ * the table has not been seeded yet or can not be trusted any more.
+ * Returns TAPI error code like tel_get_call_status_all().
+ */
+static int _get_call_table(telephony_data *data, GArray *calls)
+{
+	telephony_call_table *table = &data->call_table;
+	guint generation;
+	int ret;
+
+	g_mutex_lock(&table->mutex);
+	if (table->valid && !table->dirty) {
+		g_array_append_vals(calls, table->calls->data, table->calls->len);
+		g_mutex_unlock(&table->mutex);
+		return TAPI_API_SUCCESS;
+	}
+	generation = table->generation;
+	g_mutex_unlock(&table->mutex);
+
+	ret = tel_get_call_status_all(data->tapi_h, _get_call_status_cb, calls);
+	if (ret == TAPI_API_SUCCESS) {
+		g_mutex_lock(&table->mutex);
+		/* Do not overwrite changes which have been notified while it was fetched */
+		if (table->call_signal_id && table->generation == generation) {
+			g_array_set_size(table->calls, 0);
+			g_array_append_vals(table->calls, calls->data, calls->len);
+			table->valid = TRUE;
+			table->dirty = FALSE;
+		}
+		g_mutex_unlock(&table->mutex);
+	}
+
+	return ret;
+}
+
+static void _mapping_call_status_to_state(telephony_call_status_e status,
+	telephony_call_state_e *call_state)
+{
+	switch (status) {
+	case TELEPHONY_CALL_STATUS_ACTIVE:
+		_mapping_call_state(TAPI_CALL_STATE_ACTIVE, call_state);
+		break;
+	case TELEPHONY_CALL_STATUS_HELD:
+		_mapping_call_state(TAPI_CALL_STATE_HELD, call_state);
+		break;
+	case TELEPHONY_CALL_STATUS_DIALING:
+		_mapping_call_state(TAPI_CALL_STATE_DIALING, call_state);
+		break;
+	case TELEPHONY_CALL_STATUS_ALERTING:
+		_mapping_call_state(TAPI_CALL_STATE_ALERT, call_state);
+		break;
+	case TELEPHONY_CALL_STATUS_INCOMING:
+		_mapping_call_state(TAPI_CALL_STATE_INCOMING, call_state);
+		break;
+	case TELEPHONY_CALL_STATUS_IDLE:
+	default:
+		break;
+	}
+}
+
+/* Aggregated state of the video calls if video is TRUE and of the voice calls otherwise */
+static telephony_call_state_e _calls_get_state(GArray *calls, gboolean video)
+{
+	telephony_call_state_e call_state = TELEPHONY_CALL_STATE_IDLE;
+	guint i;
+
+	for (i = 0; i < calls->len; i++) {
+		telephony_call_info_s *call_info = &g_array_index(calls, telephony_call_info_s, i);
+
+		if ((call_info->type == TELEPHONY_CALL_TYPE_VIDEO) == video)
+			_mapping_call_status_to_state(call_info->status, &call_state);
+	}
+
+	return call_state;
+}
+
+/* Returns TAPI error code */
+static int _get_call_state(telephony_data *data, gboolean video, telephony_call_state_e *call_state)
+{
+	GArray *calls = g_array_sized_new(FALSE, TRUE, sizeof(telephony_call_info_s), CALL_TABLE_RESERVED_SIZE);
+	int ret;
+
+	*call_state = TELEPHONY_CALL_STATE_IDLE;
+
+	ret = _get_call_table(data, calls);
+	if (ret == TAPI_API_SUCCESS)
+		*call_state = _calls_get_state(calls, video);
+	g_array_free(calls, TRUE);
+
+	return ret;
+}
+
+void _telephony_call_table_seed(telephony_data *data)
+{
+	GArray *calls = g_array_sized_new(FALSE, TRUE, sizeof(telephony_call_info_s), CALL_TABLE_RESERVED_SIZE);
+
+	if (_get_call_table(data, calls) != TAPI_API_SUCCESS)
+		LOGE("Call table seeding failed");
+	g_array_free(calls, TRUE);
+}
+
+int _telephony_call_table_get_state_for_event(telephony_data *data,
+	const char *evt_id, unsigned int call_id, telephony_call_state_e *call_state)
+{
+	telephony_call_table *table = &data->call_table;
+	int count = sizeof(call_status_noti_tbl) / sizeof(call_status_noti_tbl[0]);
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (!g_strcmp0(call_status_noti_tbl[i].noti, evt_id))
+			break;
+	}
+	if (i == count)
+		return TELEPHONY_ERROR_INVALID_PARAMETER;
+
+	g_mutex_lock(&table->mutex);
+	/*
+	 * The call signal may not have reached the table yet, applying the
+	 * same status twice leaves the table unchanged
+	 */
+	_call_table_update(table, call_id, call_status_noti_tbl[i].type,
+		call_status_noti_tbl[i].status, "");
+	*call_state = _calls_get_state(table->calls,
+		call_status_noti_tbl[i].type == TELEPHONY_CALL_TYPE_VIDEO);
+	g_mutex_unlock(&table->mutex);
+
+	return TELEPHONY_ERROR_NONE;
 }
 
 int telephony_call_get_voice_call_state(telephony_h handle, telephony_call_state_e *call_state)
@@ -141,7 +452,7 @@ int telephony_call_get_voice_call_state(telephony_h handle, telephony_call_state
 
 	*call_state = TELEPHONY_CALL_STATE_IDLE;
 
-	ret = tel_get_call_status_all(tapi_h, _voice_call_get_state_cb, call_state);
+	ret = _get_call_state((telephony_data *)handle, FALSE, call_state);
 	if (ret == TAPI_API_ACCESS_DENIED) {
 		LOGE("PERMISSION_DENIED");
 		return TELEPHONY_ERROR_PERMISSION_DENIED;
@@ -168,7 +479,7 @@ int telephony_call_get_video_call_state(telephony_h handle, telephony_call_state
 
 	*call_state = TELEPHONY_CALL_STATE_IDLE;
 
-	ret = tel_get_call_status_all(tapi_h, _video_call_get_state_cb, call_state);
+	ret = _get_call_state((telephony_data *)handle, TRUE, call_state);
 	if (ret == TAPI_API_ACCESS_DENIED) {
 		LOGE("PERMISSION_DENIED");
 		return TELEPHONY_ERROR_PERMISSION_DENIED;
@@ -224,13 +535,36 @@ int telephony_call_get_preferred_voice_subscription(telephony_h handle, telephon
 	return TELEPHONY_ERROR_NONE;
 }
 
+/*
+ * One block holds the handle array followed by the records it points to,
+ * see telephony_call_release_call_list(). The array is made of pointers,
+ * so the records which follow it are suitably aligned.
+ */
+static telephony_call_h *_call_list_new(const telephony_call_info_s *calls, unsigned int count)
+{
+	telephony_call_h *call_list;
+	telephony_call_info_s *records;
+	unsigned int i;
+
+	if (count == 0)
+		return NULL;
+
+	call_list = g_malloc(count * (sizeof(telephony_call_h) + sizeof(telephony_call_info_s)));
+	records = (telephony_call_info_s *)(call_list + count);
+	memcpy(records, calls, count * sizeof(telephony_call_info_s));
+	for (i = 0; i < count; i++)
+		call_list[i] = (telephony_call_h)&records[i];
+
+	return call_list;
+}
+
 int telephony_call_get_call_list(telephony_h handle,
 	unsigned int *count, telephony_call_h **call_list)
 {
 	int ret;
 	TapiHandle *tapi_h;
-	GSList *list = NULL, *tmp;
-	unsigned int call_index = 0;
+	telephony_call_table *table;
+	GArray *calls;
 
 	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
 	CHECK_INPUT_PARAMETER(handle);
@@ -238,47 +572,46 @@ int telephony_call_get_call_list(telephony_h handle,
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(call_list);
 	CHECK_INPUT_PARAMETER(count);
+	table = &((telephony_data *)handle)->call_table;
+
+	/* Built straight from the call table, this is the only allocation */
+	g_mutex_lock(&table->mutex);
+	if (table->valid && !table->dirty) {
+		*count = table->calls->len;
+		*call_list = _call_list_new((telephony_call_info_s *)table->calls->data, *count);
+		g_mutex_unlock(&table->mutex);
+		return TELEPHONY_ERROR_NONE;
+	}
+	g_mutex_unlock(&table->mutex);
 
-	ret = tel_get_call_status_all(tapi_h, _get_call_status_cb, &list);
+	calls = g_array_sized_new(FALSE, TRUE, sizeof(telephony_call_info_s), CALL_TABLE_RESERVED_SIZE);
+	ret = _get_call_table((telephony_data *)handle, calls);
 	if (ret == TAPI_API_ACCESS_DENIED) {
 		LOGE("PERMISSION_DENIED");
+		g_array_free(calls, TRUE);
 		return TELEPHONY_ERROR_PERMISSION_DENIED;
 	} else if (ret != TAPI_API_SUCCESS) {
 		LOGE("OPERATION_FAILED");
+		g_array_free(calls, TRUE);
 		return TELEPHONY_ERROR_OPERATION_FAILED;
 	}
 
-	if (g_slist_length(list)) {
-		*count = g_slist_length(list);
-		*call_list = g_malloc0(*count * sizeof(telephony_call_h));
-
-		tmp = list;
-		while (tmp) {
-			telephony_call_info_s *call_info = tmp->data;
-			(*call_list)[call_index] = g_malloc0(sizeof(telephony_call_info_s));
-			memcpy((*call_list)[call_index], call_info, sizeof(telephony_call_info_s));
-			tmp = g_slist_next(tmp);
-			call_index++;
-		}
-		g_slist_free(list);
-	} else {
-		*count = 0;
-		*call_list = NULL;
-	}
+	*count = calls->len;
+	*call_list = _call_list_new((telephony_call_info_s *)calls->data, *count);
+	g_array_free(calls, TRUE);
 
 	return TELEPHONY_ERROR_NONE;
 }
 
 int telephony_call_release_call_list(unsigned int count, telephony_call_h **call_list)
 {
-	int i;
 	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
 	CHECK_INPUT_PARAMETER(call_list);
 
+	/* The call handles live in the same block as the list itself */
 	if (count > 0) {
-		for (i = 0; i < count; i++)
-			g_free((telephony_call_info_s *)(*call_list)[i]);
 		g_free(*call_list);
+		*call_list = NULL;
 	}
 
 	return TELEPHONY_ERROR_NONE;
@@ -28,33 +28,40 @@
 #include <TelNetwork.h>
 #include <TapiUtility.h>
 
+/* Subscribers of one event which can be dispatched without allocation */
+#define TELEPHONY_NOTI_SUBSCRIBERS_ON_STACK 8
+
 #define CALLBACK_CALL(data) \
 	if (evt_cb_data->cb) { \
 		evt_cb_data->cb(evt_cb_data->handle, \
 			 evt_cb_data->noti_id, data, evt_cb_data->user_data); \
 	}
 
-/* Handle deprecated noti_id for backward compatibility */
-#define CALLBACK_CALL_FOR_DEPRECATED_NOTI(evt_cb_data) \
-	if (evt_cb_data->noti_id == TELEPHONY_NOTI_VOICE_CALL_STATE) { \
-		telephony_call_state_e call_state; \
-		telephony_call_get_voice_call_state(evt_cb_data->handle, &call_state); \
-		CALLBACK_CALL(&call_state); \
-		return; \
-	} else if (evt_cb_data->noti_id == TELEPHONY_NOTI_VIDEO_CALL_STATE) { \
-		telephony_call_state_e call_state; \
-		telephony_call_get_video_call_state(evt_cb_data->handle, &call_state); \
-		CALLBACK_CALL(&call_state); \
-		return; \
-	}
-
+/* A subscription made with telephony_set_noti_cb() */
 typedef struct {
 	telephony_h handle;
 	telephony_noti_e noti_id;
 	telephony_noti_cb cb;
 	void *user_data;
+	telephony_event_queue_h queue; /* Set instead of cb for an event queue */
+	telephony_noti_batch_h batch; /* Set instead of cb for a batch callback */
+	telephony_noti_policy_s policy; /* Delivery policy of cb, see _dispatch_with_policy() */
+	gint64 last_delivery; /* Monotonic time cb was last called */
+	gboolean trailing_pending; /* A trailing edge delivery of pending is scheduled */
+	telephony_evt_payload_type_e pending_type;
+	telephony_event_s pending; /* Latest suppressed value, delivered on the trailing edge */
+	gint ref_count; /* Held by the registry and by each dispatch in progress */
+	gint removed; /* Set once unsubscribed, pending dispatches skip it */
+	gint fresh; /* Missed the latest value, or was delivered none yet: the value filter lets the next one through */
 } telephony_evt_cb_data;
 
+/* Subscribers of one TAPI event, registered to TAPI only once per handle */
+typedef struct {
+	const char *evt_id;
+	gboolean tapi_registered; /* FALSE if delivered by the call table instead */
+	GSList *subscribers; /* telephony_evt_cb_data, in registration order */
+} telephony_noti_event;
+
 static const char *voice_call_state_tbl[] = {
 	TAPI_NOTI_VOICE_CALL_STATUS_IDLE,
 	TAPI_NOTI_VOICE_CALL_STATUS_ACTIVE,
@@ -72,6 +79,59 @@ static const char *video_call_state_tbl[] = {
 	TAPI_NOTI_VIDEO_CALL_STATUS_INCOMING
 };
 
+/*
+ * Cached result of the TELEPHONY_FEATURE check.
+ * Platform features cannot change at runtime, so System Info is asked
+ * only once per process instead of on every API call.
+ */
+enum {
+	FEATURE_STATE_UNKNOWN = 0,
+	FEATURE_STATE_SUPPORTED,
+	FEATURE_STATE_NOT_SUPPORTED
+};
+
+static gint feature_state = FEATURE_STATE_UNKNOWN;
+
+int _telephony_check_feature_supported(const char *feature_name)
+{
+	bool telephony_supported = FALSE;
+	gint state = g_atomic_int_get(&feature_state);
+
+	if (state == FEATURE_STATE_UNKNOWN) {
+		/* A failed lookup is not cached, it will be retried by the next call */
+		if (system_info_get_platform_bool(feature_name, &telephony_supported)) {
+			LOGE("Error - Feature getting from System Info");
+			return TELEPHONY_ERROR_OPERATION_FAILED;
+		}
+
+		state = telephony_supported ? FEATURE_STATE_SUPPORTED : FEATURE_STATE_NOT_SUPPORTED;
+		g_atomic_int_set(&feature_state, state);
+	}
+
+	if (state == FEATURE_STATE_NOT_SUPPORTED) {
+		LOGE("telephony feature is disabled");
+		return TELEPHONY_ERROR_NOT_SUPPORTED;
+	}
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+gboolean _telephony_variant_get_int(GVariant *value, int *result)
+{
+	if (g_variant_is_of_type(value, G_VARIANT_TYPE_INT32))
+		*result = g_variant_get_int32(value);
+	else if (g_variant_is_of_type(value, G_VARIANT_TYPE_UINT32))
+		*result = (int)g_variant_get_uint32(value);
+	else if (g_variant_is_of_type(value, G_VARIANT_TYPE_BOOLEAN))
+		*result = g_variant_get_boolean(value) ? 1 : 0;
+	else if (g_variant_is_of_type(value, G_VARIANT_TYPE_BYTE))
+		*result = g_variant_get_byte(value);
+	else
+		return FALSE;
+
+	return TRUE;
+}
+
 static const char *_mapping_noti_id(telephony_noti_e noti_id)
 {
 	switch (noti_id) {
@@ -177,318 +237,1542 @@ static int _mapping_service_state(int tapi_service_type)
 	return service_state;
 }
 
-static telephony_error_e __deregister_all_noti(telephony_h handle, telephony_noti_e noti_id)
+/* Notification payload decoded from the TAPI event data */
+typedef struct {
+	telephony_evt_payload_type_e type;
+	union {
+		int int_value;
+		unsigned int handle_id;
+		const char *string;
+	} value;
+	gint64 timestamp; /* Monotonic time the event was received */
+	gint64 dispatched; /* Monotonic time the event was taken out of its lane */
+	telephony_call_state_e call_state; /* For call status events, the deprecated call state once applied */
+} telephony_evt_payload;
+
+typedef void (*telephony_evt_decode_cb)(void *data, telephony_evt_payload *payload);
+
+static void _decode_sim_status(void *data, telephony_evt_payload *payload)
 {
-	const char *tapi_noti;
-	int ret, i;
-	TapiHandle *tapi_h;
+	payload->type = EVT_PAYLOAD_INT;
+	payload->value.int_value = _mapping_sim_status(*(TelSimCardStatus_t *)data);
+}
 
-	CHECK_INPUT_PARAMETER(handle);
-	tapi_h = ((telephony_data *)handle)->tapi_h;
+static void _decode_service_state(void *data, telephony_evt_payload *payload)
+{
+	payload->type = EVT_PAYLOAD_INT;
+	payload->value.int_value = _mapping_service_state(*(int *)data);
+}
 
-	tapi_noti = _mapping_noti_id(noti_id);
-	if (tapi_noti == NULL && noti_id != TELEPHONY_NOTI_VOICE_CALL_STATE
-			&& noti_id != TELEPHONY_NOTI_VIDEO_CALL_STATE) {
-		LOGE("Not supported noti_id");
-		return TELEPHONY_ERROR_INVALID_PARAMETER;
+static void _decode_int(void *data, telephony_evt_payload *payload)
+{
+	payload->type = EVT_PAYLOAD_INT;
+	payload->value.int_value = *(int *)data;
+}
+
+static void _decode_string(void *data, telephony_evt_payload *payload)
+{
+	payload->type = EVT_PAYLOAD_STRING;
+	payload->value.string = data;
+}
+
+static void _decode_call_idle(void *data, telephony_evt_payload *payload)
+{
+	payload->type = EVT_PAYLOAD_HANDLE_ID;
+	payload->value.handle_id = ((TelCallStatusIdleNoti_t *)data)->id;
+}
+
+static void _decode_call_active(void *data, telephony_evt_payload *payload)
+{
+	payload->type = EVT_PAYLOAD_HANDLE_ID;
+	payload->value.handle_id = ((TelCallStatusActiveNoti_t *)data)->id;
+}
+
+static void _decode_call_held(void *data, telephony_evt_payload *payload)
+{
+	payload->type = EVT_PAYLOAD_HANDLE_ID;
+	payload->value.handle_id = ((TelCallStatusHeldNoti_t *)data)->id;
+}
+
+static void _decode_call_dialing(void *data, telephony_evt_payload *payload)
+{
+	payload->type = EVT_PAYLOAD_HANDLE_ID;
+	payload->value.handle_id = ((TelCallStatusDialingNoti_t *)data)->id;
+}
+
+static void _decode_call_alert(void *data, telephony_evt_payload *payload)
+{
+	payload->type = EVT_PAYLOAD_HANDLE_ID;
+	payload->value.handle_id = ((TelCallStatusAlertNoti_t *)data)->id;
+}
+
+static void _decode_call_incoming(void *data, telephony_evt_payload *payload)
+{
+	payload->type = EVT_PAYLOAD_HANDLE_ID;
+	payload->value.handle_id = ((TelCallIncomingCallInfo_t *)data)->CallHandle;
+}
+
+/*
+ * TAPI events handled by on_signal_callback().
+ * Call status events are delivered by the call table instead, which watches
+ * the whole call interface with a single match rule.
+ */
+static const struct {
+	const char *evt_id;
+	telephony_noti_e noti_id;
+	telephony_evt_decode_cb decode;
+	gboolean call_status;
+	gboolean property; /* Carries a value, repeating it again is not a change */
+	telephony_noti_lane_e lane;
+} evt_dispatch_tbl[] = {
+	{ TAPI_PROP_NETWORK_SIGNALSTRENGTH_LEVEL, TELEPHONY_NOTI_NETWORK_SIGNALSTRENGTH_LEVEL, _decode_int, FALSE, TRUE, NOTI_LANE_LOW },
+	{ TAPI_PROP_NETWORK_CELLID, TELEPHONY_NOTI_NETWORK_CELLID, _decode_int, FALSE, TRUE, NOTI_LANE_LOW },
+	{ TAPI_PROP_NETWORK_SERVICE_TYPE, TELEPHONY_NOTI_NETWORK_SERVICE_STATE, _decode_service_state, FALSE, TRUE, NOTI_LANE_LOW },
+	{ TAPI_PROP_NETWORK_ROAMING_STATUS, TELEPHONY_NOTI_NETWORK_ROAMING_STATUS, _decode_int, FALSE, TRUE, NOTI_LANE_LOW },
+	{ TAPI_PROP_NETWORK_NETWORK_NAME, TELEPHONY_NOTI_NETWORK_NETWORK_NAME, _decode_string, FALSE, TRUE, NOTI_LANE_LOW },
+	{ TAPI_PROP_NETWORK_PS_TYPE, TELEPHONY_NOTI_NETWORK_PS_TYPE, _decode_int, FALSE, TRUE, NOTI_LANE_LOW },
+	{ TAPI_NOTI_NETWORK_DEFAULT_DATA_SUBSCRIPTION, TELEPHONY_NOTI_NETWORK_DEFAULT_DATA_SUBSCRIPTION, _decode_int, FALSE, TRUE, NOTI_LANE_LOW },
+	{ TAPI_NOTI_NETWORK_DEFAULT_SUBSCRIPTION, TELEPHONY_NOTI_NETWORK_DEFAULT_SUBSCRIPTION, _decode_int, FALSE, TRUE, NOTI_LANE_LOW },
+	{ TAPI_NOTI_SIM_STATUS, TELEPHONY_NOTI_SIM_STATUS, _decode_sim_status, FALSE, TRUE, NOTI_LANE_HIGH },
+	{ TAPI_NOTI_VOICE_CALL_STATUS_IDLE, TELEPHONY_NOTI_VOICE_CALL_STATUS_IDLE, _decode_call_idle, TRUE, FALSE, NOTI_LANE_HIGH },
+	{ TAPI_NOTI_VOICE_CALL_STATUS_ACTIVE, TELEPHONY_NOTI_VOICE_CALL_STATUS_ACTIVE, _decode_call_active, TRUE, FALSE, NOTI_LANE_HIGH },
+	{ TAPI_NOTI_VOICE_CALL_STATUS_HELD, TELEPHONY_NOTI_VOICE_CALL_STATUS_HELD, _decode_call_held, TRUE, FALSE, NOTI_LANE_HIGH },
+	{ TAPI_NOTI_VOICE_CALL_STATUS_DIALING, TELEPHONY_NOTI_VOICE_CALL_STATUS_DIALING, _decode_call_dialing, TRUE, FALSE, NOTI_LANE_HIGH },
+	{ TAPI_NOTI_VOICE_CALL_STATUS_ALERT, TELEPHONY_NOTI_VOICE_CALL_STATUS_ALERTING, _decode_call_alert, TRUE, FALSE, NOTI_LANE_HIGH },
+	{ TAPI_NOTI_VOICE_CALL_STATUS_INCOMING, TELEPHONY_NOTI_VOICE_CALL_STATUS_INCOMING, _decode_call_incoming, TRUE, FALSE, NOTI_LANE_HIGH },
+	{ TAPI_NOTI_VIDEO_CALL_STATUS_IDLE, TELEPHONY_NOTI_VIDEO_CALL_STATUS_IDLE, _decode_call_idle, TRUE, FALSE, NOTI_LANE_HIGH },
+	{ TAPI_NOTI_VIDEO_CALL_STATUS_ACTIVE, TELEPHONY_NOTI_VIDEO_CALL_STATUS_ACTIVE, _decode_call_active, TRUE, FALSE, NOTI_LANE_HIGH },
+	{ TAPI_NOTI_VIDEO_CALL_STATUS_DIALING, TELEPHONY_NOTI_VIDEO_CALL_STATUS_DIALING, _decode_call_dialing, TRUE, FALSE, NOTI_LANE_HIGH },
+	{ TAPI_NOTI_VIDEO_CALL_STATUS_ALERT, TELEPHONY_NOTI_VIDEO_CALL_STATUS_ALERTING, _decode_call_alert, TRUE, FALSE, NOTI_LANE_HIGH },
+	{ TAPI_NOTI_VIDEO_CALL_STATUS_INCOMING, TELEPHONY_NOTI_VIDEO_CALL_STATUS_INCOMING, _decode_call_incoming, TRUE, FALSE, NOTI_LANE_HIGH },
+	{ TAPI_NOTI_CALL_PREFERRED_VOICE_SUBSCRIPTION, TELEPHONY_NOTI_CALL_PREFERRED_VOICE_SUBSCRIPTION, _decode_int, FALSE, TRUE, NOTI_LANE_HIGH }
+};
+
+#define EVT_DISPATCH_TBL_SIZE (sizeof(evt_dispatch_tbl) / sizeof(evt_dispatch_tbl[0]))
+
+/*
+ * Maps a TAPI event name to its index in evt_dispatch_tbl + 1.
+ * Built once per process, it is read-only afterwards.
+ */
+static GHashTable *_get_evt_dispatch_map(void)
+{
+	static GHashTable *evt_dispatch_map;
+	static gsize initialized;
+
+	if (g_once_init_enter(&initialized)) {
+		int count = EVT_DISPATCH_TBL_SIZE;
+		int i;
+
+		evt_dispatch_map = g_hash_table_new(g_str_hash, g_str_equal);
+		for (i = 0; i < count; i++)
+			g_hash_table_insert(evt_dispatch_map,
+				(gpointer)evt_dispatch_tbl[i].evt_id, GINT_TO_POINTER(i + 1));
+		g_once_init_leave(&initialized, 1);
 	}
 
-	/* Deregister all TAPI_NOTI_VOICE/VIDEO_CALL_STATUS_xxx notification */
-	if (noti_id == TELEPHONY_NOTI_VOICE_CALL_STATE) {
-		int count = sizeof(voice_call_state_tbl) / sizeof(char *);
-		for (i = 0; i < count; i++) {
-			ret = tel_deregister_noti_event(tapi_h, voice_call_state_tbl[i]);
-			if (ret != TAPI_API_SUCCESS)
-				LOGE("Noti [%s] deregistration failed", voice_call_state_tbl[i]);
-		}
-	} else if (noti_id == TELEPHONY_NOTI_VIDEO_CALL_STATE) {
-		int count = sizeof(video_call_state_tbl) / sizeof(char *);
-		for (i = 0; i < count; i++) {
-			ret = tel_deregister_noti_event(tapi_h, video_call_state_tbl[i]);
-			if (ret != TAPI_API_SUCCESS)
-				LOGE("Noti [%s] deregistration failed", video_call_state_tbl[i]);
-		}
-	} else {
-		/* Deregister other notifications */
-		ret = tel_deregister_noti_event(tapi_h, tapi_noti);
-		if (ret != TAPI_API_SUCCESS)
-			LOGE("Noti [%s] deregistration failed", tapi_noti);
+	return evt_dispatch_map;
+}
+
+static gboolean _is_call_status_event(const char *evt_id)
+{
+	int idx = GPOINTER_TO_INT(g_hash_table_lookup(_get_evt_dispatch_map(), evt_id)) - 1;
+
+	return idx >= 0 && evt_dispatch_tbl[idx].call_status;
+}
+
+static void _evt_cb_data_unref(telephony_evt_cb_data *evt_cb_data);
+
+static telephony_noti_counters *_get_noti_counters(telephony_evt_cb_data *evt_cb_data)
+{
+	return &((telephony_data *)evt_cb_data->handle)->noti_stats[evt_cb_data->noti_id];
+}
+
+/* Copies the notification data of evt_cb_data to event */
+static void _fill_event(telephony_evt_cb_data *evt_cb_data, telephony_evt_payload_type_e type,
+	const void *data, gint64 timestamp, telephony_event_s *event)
+{
+	event->noti_id = evt_cb_data->noti_id;
+	event->handle = evt_cb_data->handle;
+	event->timestamp = (unsigned long long)timestamp;
+	switch (type) {
+	case EVT_PAYLOAD_HANDLE_ID:
+		event->data.handle_id = *(const unsigned int *)data;
+		break;
+	case EVT_PAYLOAD_STRING:
+		g_strlcpy(event->data.string, data ? data : "", sizeof(event->data.string));
+		break;
+	case EVT_PAYLOAD_INT:
+	default:
+		event->data.int_value = *(const int *)data;
+		break;
 	}
+}
 
-	return TELEPHONY_ERROR_NONE;
+/* The notification data of event, as given to telephony_noti_cb */
+static void *_get_event_data(telephony_event_s *event, telephony_evt_payload_type_e type)
+{
+	switch (type) {
+	case EVT_PAYLOAD_HANDLE_ID:
+		return &event->data.handle_id;
+	case EVT_PAYLOAD_STRING:
+		return event->data.string;
+	case EVT_PAYLOAD_INT:
+	default:
+		return &event->data.int_value;
+	}
 }
 
-static void _deregister_noti(gpointer data)
+/* Timing of the callback running in this thread, see telephony_noti_get_timing() */
+static GPrivate current_timing = G_PRIVATE_INIT(NULL);
+
+static void _histogram_add(gint *histogram, gint64 usec)
 {
-	telephony_evt_cb_data *evt_cb_data = data;
+	int bucket = 0;
 
-	if (evt_cb_data != NULL) {
-		/* Deregister all TAPI_NOTI_VOICE/VIDEO_CALL_STATUS_xxx notification */
-		if (__deregister_all_noti(evt_cb_data->handle, evt_cb_data->noti_id)
-				== TELEPHONY_ERROR_NONE) {
-			LOGI("De-registered noti_id: [%d]", evt_cb_data->noti_id);
-		}
+	/* Bucket i counts the values in [2^i, 2^(i+1)) microseconds */
+	while (usec >= 2 && bucket < TELEPHONY_NOTI_HISTOGRAM_BUCKETS - 1) {
+		usec >>= 1;
+		bucket++;
+	}
+	g_atomic_int_inc(&histogram[bucket]);
+}
 
-		/* Free evt_cb_data */
-		g_free(evt_cb_data);
+/* Logs and remembers a callback which ran longer than the budget of its handle */
+static void _record_slow_callback(telephony_evt_cb_data *evt_cb_data, gint64 duration)
+{
+	telephony_data *handle_data = (telephony_data *)evt_cb_data->handle;
+	telephony_noti_slow_callback_s *slow = NULL;
+	guint i;
+
+	LOGW("Slow callback [%p] of noti_id [%d]: [%lld] us",
+		evt_cb_data->cb, evt_cb_data->noti_id, (long long)duration);
+	g_atomic_int_inc(&_get_noti_counters(evt_cb_data)->slow);
+
+	g_mutex_lock(&handle_data->noti_mutex);
+	for (i = 0; i < handle_data->noti_slow_callback_count; i++) {
+		if (handle_data->noti_slow_callbacks[i].cb == evt_cb_data->cb
+				&& handle_data->noti_slow_callbacks[i].noti_id == evt_cb_data->noti_id) {
+			slow = &handle_data->noti_slow_callbacks[i];
+			break;
+		}
+	}
+	/* Once the table is full, only the callbacks already in it are tracked */
+	if (slow == NULL && handle_data->noti_slow_callback_count < TELEPHONY_NOTI_SLOW_CALLBACKS_MAX) {
+		slow = &handle_data->noti_slow_callbacks[handle_data->noti_slow_callback_count++];
+		slow->cb = evt_cb_data->cb;
+		slow->noti_id = evt_cb_data->noti_id;
 	}
+	if (slow) {
+		slow->count++;
+		if (duration > slow->max_duration_us)
+			slow->max_duration_us = (unsigned int)duration;
+	}
+	g_mutex_unlock(&handle_data->noti_mutex);
 }
 
-static void on_signal_callback(TapiHandle *tapi_h, const char *evt_id,
-	void *data, void *user_data)
+/* Calls cb of evt_cb_data and records its timing */
+static void _invoke_callback(telephony_evt_cb_data *evt_cb_data, void *data,
+	gint64 received, gint64 dispatched)
+{
+	telephony_noti_counters *counters = _get_noti_counters(evt_cb_data);
+	telephony_noti_timing_s timing;
+	gpointer outer = g_private_get(&current_timing);
+	gint64 start, end;
+
+	start = g_get_monotonic_time();
+	timing.received = (unsigned long long)received;
+	timing.dispatched = (unsigned long long)dispatched;
+	timing.callback_start = (unsigned long long)start;
+
+	g_private_set(&current_timing, &timing);
+	CALLBACK_CALL(data);
+	g_private_set(&current_timing, outer);
+
+	/* The callback may have unset itself or deinitialized the handle */
+	if (g_atomic_int_get(&evt_cb_data->removed))
+		return;
+
+	end = g_get_monotonic_time();
+	g_atomic_int_inc(&counters->delivered);
+	_histogram_add(counters->latency, start - received);
+	_histogram_add(counters->duration, end - start);
+	if (end - start > g_atomic_int_get(&((telephony_data *)evt_cb_data->handle)->noti_callback_budget))
+		_record_slow_callback(evt_cb_data, end - start);
+}
+
+/* Copies the notification data to the queue or the batch of evt_cb_data */
+static void _enqueue_event(telephony_evt_cb_data *evt_cb_data,
+	telephony_evt_payload_type_e type, const void *data, gint64 timestamp)
+{
+	telephony_event_s event;
+
+	_fill_event(evt_cb_data, type, data, timestamp, &event);
+	if (evt_cb_data->queue)
+		_telephony_event_queue_push(evt_cb_data->queue, &event);
+	else
+		_telephony_noti_batch_append(evt_cb_data->batch, &event);
+}
+
+static gboolean _on_trailing_edge(gpointer user_data)
 {
 	telephony_evt_cb_data *evt_cb_data = user_data;
 
-	if (evt_cb_data == NULL) {
-		LOGE("evt_cb_data is NULL");
+	evt_cb_data->trailing_pending = FALSE;
+	if (g_atomic_int_get(&evt_cb_data->removed))
+		return FALSE;
+
+	evt_cb_data->last_delivery = g_get_monotonic_time();
+	_invoke_callback(evt_cb_data, _get_event_data(&evt_cb_data->pending, evt_cb_data->pending_type),
+		(gint64)evt_cb_data->pending.timestamp, evt_cb_data->last_delivery);
+
+	return FALSE;
+}
+
+/*
+ * Applies the policy of evt_cb_data: cb is called at most once per
+ * min_interval_ms, the events in between are dropped, or coalesced into the
+ * latest one and delivered when the interval ends if trailing_edge is set.
+ * Runs on the thread dispatching the handle only, like the trailing edge.
+ */
+static void _dispatch_with_policy(telephony_evt_cb_data *evt_cb_data,
+	telephony_evt_payload_type_e type, void *data, const telephony_evt_payload *payload)
+{
+	telephony_noti_counters *counters = _get_noti_counters(evt_cb_data);
+	gint64 interval = (gint64)evt_cb_data->policy.min_interval_ms * 1000;
+	gint64 timestamp = payload->timestamp;
+	/* Intervals are measured between deliveries, like the trailing edge does */
+	gint64 now = g_get_monotonic_time();
+	gint64 remaining;
+	GSource *source;
+
+	if (!evt_cb_data->trailing_pending
+			&& (evt_cb_data->last_delivery == 0
+				|| now - evt_cb_data->last_delivery >= interval)) {
+		evt_cb_data->last_delivery = now;
+		_invoke_callback(evt_cb_data, data, timestamp, payload->dispatched);
 		return;
 	}
 
-	if (!g_strcmp0(evt_id, TAPI_NOTI_SIM_STATUS)) {
-		int sim_status = _mapping_sim_status(*(TelSimCardStatus_t *)data);
-		CALLBACK_CALL(&sim_status);
-	} else if (!g_strcmp0(evt_id, TAPI_PROP_NETWORK_SERVICE_TYPE)) {
-		int service_state = _mapping_service_state(*(int *)data);
-		CALLBACK_CALL(&service_state);
-	} else if (!g_strcmp0(evt_id, TAPI_PROP_NETWORK_CELLID)) {
-		int cell_id = *(int *)data;
-		CALLBACK_CALL(&cell_id);
-	} else if (!g_strcmp0(evt_id, TAPI_PROP_NETWORK_ROAMING_STATUS)) {
-		int roaming_status = *(int *)data;
-		CALLBACK_CALL(&roaming_status);
-	} else if (!g_strcmp0(evt_id, TAPI_PROP_NETWORK_SIGNALSTRENGTH_LEVEL)) {
-		int rssi = *(int *)data;
-		CALLBACK_CALL(&rssi);
-	} else if (!g_strcmp0(evt_id, TAPI_PROP_NETWORK_NETWORK_NAME)) {
-		char *network_name = data;
-		CALLBACK_CALL(network_name);
-	} else if (!g_strcmp0(evt_id, TAPI_PROP_NETWORK_PS_TYPE)) {
-		int ps_type = *(int *)data;
-		CALLBACK_CALL(&ps_type);
-	} else if (!g_strcmp0(evt_id, TAPI_NOTI_NETWORK_DEFAULT_DATA_SUBSCRIPTION)) {
-		int default_data_sub = *(int *)data;
-		CALLBACK_CALL(&default_data_sub);
-	} else if (!g_strcmp0(evt_id, TAPI_NOTI_NETWORK_DEFAULT_SUBSCRIPTION)) {
-		int default_sub = *(int *)data;
-		CALLBACK_CALL(&default_sub);
-	} else if (!g_strcmp0(evt_id, TAPI_NOTI_VOICE_CALL_STATUS_IDLE)
-			|| !g_strcmp0(evt_id, TAPI_NOTI_VIDEO_CALL_STATUS_IDLE)) {
-		TelCallStatusIdleNoti_t *noti = data;
-		unsigned int handle_id = noti->id;
-		CALLBACK_CALL_FOR_DEPRECATED_NOTI(evt_cb_data);
-		CALLBACK_CALL(&handle_id);
-	} else if (!g_strcmp0(evt_id, TAPI_NOTI_VOICE_CALL_STATUS_ACTIVE)
-			|| !g_strcmp0(evt_id, TAPI_NOTI_VIDEO_CALL_STATUS_ACTIVE)) {
-		TelCallStatusActiveNoti_t *noti = data;
-		unsigned int handle_id = noti->id;
-		CALLBACK_CALL_FOR_DEPRECATED_NOTI(evt_cb_data);
-		CALLBACK_CALL(&handle_id);
-	} else if (!g_strcmp0(evt_id, TAPI_NOTI_VOICE_CALL_STATUS_HELD)) {
-		TelCallStatusHeldNoti_t *noti = data;
-		unsigned int handle_id = noti->id;
-		CALLBACK_CALL_FOR_DEPRECATED_NOTI(evt_cb_data);
-		CALLBACK_CALL(&handle_id);
-	} else if (!g_strcmp0(evt_id, TAPI_NOTI_VOICE_CALL_STATUS_DIALING)
-			|| !g_strcmp0(evt_id, TAPI_NOTI_VIDEO_CALL_STATUS_DIALING)) {
-		TelCallStatusDialingNoti_t *noti = data;
-		unsigned int handle_id = noti->id;
-		CALLBACK_CALL_FOR_DEPRECATED_NOTI(evt_cb_data);
-		CALLBACK_CALL(&handle_id);
-	} else if (!g_strcmp0(evt_id, TAPI_NOTI_VOICE_CALL_STATUS_ALERT)
-			|| !g_strcmp0(evt_id, TAPI_NOTI_VIDEO_CALL_STATUS_ALERT)) {
-		TelCallStatusAlertNoti_t *noti = data;
-		unsigned int handle_id = noti->id;
-		CALLBACK_CALL_FOR_DEPRECATED_NOTI(evt_cb_data);
-		CALLBACK_CALL(&handle_id);
-	} else if (!g_strcmp0(evt_id, TAPI_NOTI_VOICE_CALL_STATUS_INCOMING)
-			|| !g_strcmp0(evt_id, TAPI_NOTI_VIDEO_CALL_STATUS_INCOMING)) {
-		TelCallIncomingCallInfo_t *noti = data;
-		unsigned int handle_id = noti->CallHandle;
-		CALLBACK_CALL_FOR_DEPRECATED_NOTI(evt_cb_data);
-		CALLBACK_CALL(&handle_id);
-	} else if (!g_strcmp0(evt_id, TAPI_NOTI_CALL_PREFERRED_VOICE_SUBSCRIPTION)) {
-		int call_pref_voice_sub = *(int *)data;
-		CALLBACK_CALL(&call_pref_voice_sub);
-	} else {
-		LOGE("Unhandled noti: [%s]", evt_id);
+	if (!evt_cb_data->policy.trailing_edge) {
+		g_atomic_int_inc(&counters->suppressed);
+		/* The value filter already took this value as delivered, the next repeat must still get here */
+		g_atomic_int_set(&evt_cb_data->fresh, TRUE);
+		return;
 	}
+
+	/* Last value wins, the one it replaces is never delivered */
+	if (evt_cb_data->trailing_pending)
+		g_atomic_int_inc(&counters->suppressed);
+	_fill_event(evt_cb_data, type, data, timestamp, &evt_cb_data->pending);
+	evt_cb_data->pending_type = type;
+	if (evt_cb_data->trailing_pending)
+		return;
+
+	remaining = evt_cb_data->last_delivery + interval - now;
+	source = g_timeout_source_new((guint)((remaining + 999) / 1000));
+	g_atomic_int_inc(&evt_cb_data->ref_count);
+	g_source_set_callback(source, _on_trailing_edge, evt_cb_data, (GDestroyNotify)_evt_cb_data_unref);
+	g_source_attach(source, ((telephony_data *)evt_cb_data->handle)->context);
+	g_source_unref(source);
+	evt_cb_data->trailing_pending = TRUE;
 }
 
-int telephony_set_noti_cb(telephony_h handle,
-	telephony_noti_e noti_id, telephony_noti_cb cb, void *user_data)
+static void _dispatch_event(telephony_evt_cb_data *evt_cb_data,
+	const char *evt_id, const telephony_evt_payload *payload)
 {
-	telephony_evt_cb_data *evt_cb_data = NULL;
-	const char *tapi_noti;
-	int ret, i;
-	TapiHandle *tapi_h;
+	telephony_call_state_e call_state = TELEPHONY_CALL_STATE_IDLE;
+	telephony_evt_payload_type_e type = payload->type;
+	void *data;
 
-	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
-	CHECK_INPUT_PARAMETER(handle);
+	/* Handle deprecated noti_id for backward compatibility, without IPC */
+	if (evt_cb_data->noti_id == TELEPHONY_NOTI_VOICE_CALL_STATE
+			|| evt_cb_data->noti_id == TELEPHONY_NOTI_VIDEO_CALL_STATE) {
+		if (payload->type != EVT_PAYLOAD_HANDLE_ID)
+			return;
+		call_state = payload->call_state;
+		type = EVT_PAYLOAD_INT;
+		data = &call_state;
+	} else {
+		switch (payload->type) {
+		case EVT_PAYLOAD_HANDLE_ID:
+			data = (void *)&payload->value.handle_id;
+			break;
+		case EVT_PAYLOAD_STRING:
+			data = (void *)payload->value.string;
+			break;
+		case EVT_PAYLOAD_INT:
+		default:
+			data = (void *)&payload->value.int_value;
+			break;
+		}
+	}
 
-	LOGI("Entry");
-	tapi_h = ((telephony_data *)handle)->tapi_h;
+	if (evt_cb_data->queue || evt_cb_data->batch) {
+		g_atomic_int_inc(&_get_noti_counters(evt_cb_data)->delivered);
+		_enqueue_event(evt_cb_data, type, data, payload->timestamp);
+		return;
+	}
 
-	/* Mapping TAPI notification */
-	tapi_noti = _mapping_noti_id(noti_id);
-	if (tapi_noti == NULL && noti_id != TELEPHONY_NOTI_VOICE_CALL_STATE
-			&& noti_id != TELEPHONY_NOTI_VIDEO_CALL_STATE) {
-		LOGE("Not supported noti_id");
-		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	if (evt_cb_data->policy.min_interval_ms) {
+		_dispatch_with_policy(evt_cb_data, type, data, payload);
+		return;
 	}
 
-	/* Make evt_cb_data */
-	evt_cb_data = g_new0(telephony_evt_cb_data, 1);
-	evt_cb_data->handle = handle;
-	evt_cb_data->noti_id = noti_id;
-	evt_cb_data->cb = cb;
-	evt_cb_data->user_data = user_data;
+	_invoke_callback(evt_cb_data, data, payload->timestamp, payload->dispatched);
+}
 
+static void _evt_cb_data_unref(telephony_evt_cb_data *evt_cb_data)
+{
+	if (g_atomic_int_dec_and_test(&evt_cb_data->ref_count)) {
+		if (evt_cb_data->queue)
+			_telephony_event_queue_unref(evt_cb_data->queue);
+		if (evt_cb_data->batch)
+			_telephony_noti_batch_unref(evt_cb_data->batch);
+		g_free(evt_cb_data);
+	}
+}
+
+/* Returns the TAPI events behind noti_id, NULL if noti_id is not supported */
+static const char **_get_noti_events(telephony_noti_e noti_id,
+	const char **single, int *count)
+{
 	/*
-	 * In case of register Call State notification,
+	 * In case of Call State notification,
 	 * we should take care of all TAPI_NOTI_VOICE/VIDEO_CALL_STATUS_xxx notification
 	 */
 	if (noti_id == TELEPHONY_NOTI_VOICE_CALL_STATE) {
-		int count = sizeof(voice_call_state_tbl) / sizeof(char *);
-		for (i = 0; i < count; i++) {
-			ret = tel_register_noti_event(tapi_h, voice_call_state_tbl[i], on_signal_callback, evt_cb_data);
-			if (ret != TAPI_API_SUCCESS) {
-				LOGE("Noti registration failed");
-				g_free(evt_cb_data);
-				return TELEPHONY_ERROR_OPERATION_FAILED;
-			}
-		}
+		*count = sizeof(voice_call_state_tbl) / sizeof(char *);
+		return voice_call_state_tbl;
 	} else if (noti_id == TELEPHONY_NOTI_VIDEO_CALL_STATE) {
-		int count = sizeof(video_call_state_tbl) / sizeof(char *);
-		for (i = 0; i < count; i++) {
-			ret = tel_register_noti_event(tapi_h, video_call_state_tbl[i], on_signal_callback, evt_cb_data);
-			if (ret != TAPI_API_SUCCESS) {
-				LOGE("Noti registration failed");
-				g_free(evt_cb_data);
-				return TELEPHONY_ERROR_OPERATION_FAILED;
-			}
-		}
-	} else { /* Register other notifications */
-		ret = tel_register_noti_event(tapi_h, tapi_noti, on_signal_callback, evt_cb_data);
-		if (ret != TAPI_API_SUCCESS) {
-			LOGE("Noti registration failed");
-			g_free(evt_cb_data);
-			return TELEPHONY_ERROR_OPERATION_FAILED;
-		}
+		*count = sizeof(video_call_state_tbl) / sizeof(char *);
+		return video_call_state_tbl;
 	}
 
-	/* Append evt_cb_data to free */
-	((telephony_data *)handle)->evt_list = g_slist_append(((telephony_data *)handle)->evt_list, evt_cb_data);
-
-	return TELEPHONY_ERROR_NONE;
+	*single = _mapping_noti_id(noti_id);
+	if (*single == NULL)
+		return NULL;
+	*count = 1;
+	return single;
 }
 
-int telephony_unset_noti_cb(telephony_h handle, telephony_noti_e noti_id)
-{
-	telephony_evt_cb_data *evt_cb_data = NULL;
-	GSList *list = NULL;
+static void _dispatch_to_subscribers(telephony_data *handle_data,
+	const char *evt_id, const telephony_evt_payload *payload, gboolean fresh_only);
 
-	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
-	CHECK_INPUT_PARAMETER(handle);
+/*
+ * Returns TRUE if payload is the value last delivered for the property event
+ * idx, and remembers it otherwise
+ */
+static gboolean _noti_filter_unchanged(telephony_data *handle_data, int idx,
+	const telephony_evt_payload *payload)
+{
+	telephony_noti_last_value *last;
+	gboolean unchanged;
 
-	LOGI("Entry");
+	if (g_atomic_int_get(&handle_data->noti_filter_disabled))
+		return FALSE;
 
-	/* Deregister all TAPI_NOTI_VOICE/VIDEO_CALL_STATUS_xxx notification */
-	if (__deregister_all_noti(handle, noti_id) != TELEPHONY_ERROR_NONE) {
-		LOGE("De-registration failed");
-		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	g_mutex_lock(&handle_data->noti_mutex);
+	last = &handle_data->noti_last_values[idx];
+	if (payload->type == EVT_PAYLOAD_STRING) {
+		unchanged = last->valid && g_strcmp0(last->string, payload->value.string) == 0;
+		if (!unchanged) {
+			g_free(last->string);
+			last->string = g_strdup(payload->value.string);
+		}
+	} else {
+		unchanged = last->valid && last->int_value == payload->value.int_value;
+		last->int_value = payload->value.int_value;
 	}
-	LOGI("De-registered noti_id: [%d]", noti_id);
+	last->valid = TRUE;
+	g_mutex_unlock(&handle_data->noti_mutex);
 
-	/* Free evt_cb_data */
-	list = g_slist_nth(((telephony_data *)handle)->evt_list, 0);
-	while (list) {
-		evt_cb_data = list->data;
-		if (evt_cb_data->noti_id == noti_id) {
-			((telephony_data *)handle)->evt_list = g_slist_remove(((telephony_data *)handle)->evt_list, evt_cb_data);
-			g_free(evt_cb_data);
-			break;
-		}
+	if (unchanged)
+		g_atomic_int_inc(&handle_data->noti_stats[evt_dispatch_tbl[idx].noti_id].filtered);
 
-		list = g_slist_next(list);
-	}
+	return unchanged;
+}
 
-	return TELEPHONY_ERROR_NONE;
+/* An event waiting in a lane, see _noti_lane_push() */
+typedef struct {
+	int idx; /* In evt_dispatch_tbl */
+	telephony_evt_payload payload; /* Owns its string */
+} telephony_lane_event;
+
+static void _lane_event_free(telephony_lane_event *lane_event)
+{
+	if (lane_event->payload.type == EVT_PAYLOAD_STRING)
+		g_free((char *)lane_event->payload.value.string);
+	g_free(lane_event);
 }
 
-int telephony_init(telephony_handle_list_s *list)
+/* Priority of the source of each lane */
+static const gint noti_lane_priority[NOTI_LANE_MAX] = {
+	G_PRIORITY_HIGH, /* NOTI_LANE_HIGH: ahead of any pending D-Bus signal */
+	G_PRIORITY_DEFAULT /* NOTI_LANE_LOW: in turn with the D-Bus signals, never starved by idle work */
+};
+
+/* Default capacity and overflow policy of each lane */
+static const struct {
+	guint capacity;
+	telephony_noti_overflow_e overflow;
+} noti_lane_default_policy[NOTI_LANE_MAX] = {
+	{ 64, TELEPHONY_NOTI_OVERFLOW_NEVER_DROP }, /* NOTI_LANE_HIGH: call and SIM status */
+	{ 8, TELEPHONY_NOTI_OVERFLOW_DROP_OLDEST } /* NOTI_LANE_LOW: one per network property */
+};
+
+static gboolean _on_noti_lane_ready(gpointer user_data);
+
+/* Applies the overflow policy once the lane went beyond its capacity, noti_mutex must be held */
+static void _noti_lane_trim(telephony_noti_lane *lane)
 {
-	char **cp_list;
-	int cp_count = 0;
-	int i;
+	telephony_lane_event *lane_event;
 
-	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
-	CHECK_INPUT_PARAMETER(list);
+	if (lane->events.length <= lane->capacity)
+		return;
 
-#if !GLIB_CHECK_VERSION(2, 35, 0)
-	/* Need g_type_init() to use tel_get_cp_name_list() */
-	g_type_init();
-#endif
+	/* A call or SIM transition is never lost, the lane grows until the main loop catches up */
+	if (lane->overflow == TELEPHONY_NOTI_OVERFLOW_NEVER_DROP) {
+		if (!lane->overflowed)
+			LOGW("Lane [%d] grew beyond its capacity [%u]", lane->lane_id, lane->capacity);
+		lane->overflowed = TRUE;
+		return;
+	}
 
-	cp_list = tel_get_cp_name_list();
-	if (cp_list == NULL) {
-		LOGE("cp_list is NULL");
-		return TELEPHONY_ERROR_OPERATION_FAILED;
+	while (lane->events.length > lane->capacity) {
+		lane_event = g_queue_pop_head(&lane->events);
+		if (lane->dropped++ == 0)
+			LOGW("Lane [%d] is full, dropping the oldest events", lane->lane_id);
+		_lane_event_free(lane_event);
 	}
+}
 
-	while (cp_list[cp_count])
-		cp_count++;
+/*
+ * Queues a copy of the event idx in its lane. Call and SIM events are
+ * delivered before anything else the main loop has pending, network
+ * properties one per iteration at the default priority: a pending value of
+ * the same property is replaced instead, so a flood of them cannot delay
+ * other events. Each lane is bounded by its overflow policy, see
+ * telephony_set_noti_queue_policy().
+ */
+static void _noti_lane_push(telephony_data *handle_data, int idx, const telephony_evt_payload *payload)
+{
+	telephony_noti_lane_e lane_id = evt_dispatch_tbl[idx].lane;
+	telephony_noti_lane *lane = &handle_data->noti_lanes[lane_id];
+	telephony_lane_event *lane_event = NULL;
+	GList *list;
 
-	list->count = cp_count;
-	list->handle = g_malloc(cp_count * sizeof(telephony_h));
-	for (i = 0; i < cp_count; i++) {
-		telephony_data *tmp = g_malloc(sizeof(telephony_data));
-		tmp->evt_list = NULL;
-		tmp->tapi_h = tel_init(cp_list[i]);
-		if (tmp->tapi_h == NULL) {
-			int j = 0;
-			LOGE("handle is NULL");
-			for (; j < i; j++) {
-				/* Need to free already allocated data */
-				if (list->handle[j]) {
-					tel_deinit(((telephony_data *)list->handle[j])->tapi_h);
-					g_free(list->handle[j]);
-				}
+	g_mutex_lock(&handle_data->noti_mutex);
+	if (lane_id == NOTI_LANE_LOW) {
+		for (list = lane->events.head; list; list = list->next) {
+			if (((telephony_lane_event *)list->data)->idx == idx) {
+				lane_event = list->data;
+				if (lane_event->payload.type == EVT_PAYLOAD_STRING)
+					g_free((char *)lane_event->payload.value.string);
+				/* Counted as suppressed only, the lane did not overflow */
+				g_atomic_int_inc(&handle_data->noti_stats[evt_dispatch_tbl[idx].noti_id].suppressed);
+				break;
 			}
-			g_free(tmp);
-			g_free(list->handle);
-			list->handle = NULL;
-			list->count = 0;
-			g_strfreev(cp_list);
-			return TELEPHONY_ERROR_OPERATION_FAILED;
 		}
-		list->handle[i] = (telephony_h)tmp;
 	}
-	g_strfreev(cp_list);
+	if (lane_event == NULL) {
+		lane_event = g_new(telephony_lane_event, 1);
+		lane_event->idx = idx;
+		g_queue_push_tail(&lane->events, lane_event);
+	}
+	lane_event->payload = *payload;
+	if (payload->type == EVT_PAYLOAD_STRING)
+		lane_event->payload.value.string = g_strdup(payload->value.string);
 
-	return TELEPHONY_ERROR_NONE;
+	_noti_lane_trim(lane);
+	if (lane->events.length > lane->high_water)
+		lane->high_water = lane->events.length;
+
+	if (lane->source == NULL) {
+		lane->source = g_idle_source_new();
+		g_source_set_priority(lane->source, noti_lane_priority[lane_id]);
+		g_source_set_callback(lane->source, _on_noti_lane_ready, &handle_data->noti_lanes[lane_id], NULL);
+		g_source_attach(lane->source, handle_data->context);
+	}
+	g_mutex_unlock(&handle_data->noti_mutex);
 }
 
-int telephony_deinit(telephony_handle_list_s *list)
+/* Delivers the event idx once it is its turn */
+static void _noti_deliver(telephony_data *handle_data, int idx, telephony_evt_payload *payload)
 {
-	unsigned int i;
+	gboolean unchanged;
 
-	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
-	CHECK_INPUT_PARAMETER(list);
+	payload->dispatched = g_get_monotonic_time();
+	unchanged = evt_dispatch_tbl[idx].property
+		&& _noti_filter_unchanged(handle_data, idx, payload);
+	/* An unchanged value still goes to subscribers that have not seen one yet */
+	_dispatch_to_subscribers(handle_data, evt_dispatch_tbl[idx].evt_id, payload, unchanged);
+}
 
-	for (i = 0; i < list->count; i++) {
-		telephony_data *tmp = (telephony_data *)list->handle[i];
+static gboolean _on_noti_lane_ready(gpointer user_data)
+{
+	telephony_noti_lane *lane = user_data;
+	telephony_noti_lane_e lane_id = lane->lane_id;
+	telephony_data *handle_data = lane->handle_data;
+	telephony_lane_event *lane_event;
+	GSource *source = g_main_current_source();
 
-		/* De-init all TapiHandle */
-		tel_deinit(tmp->tapi_h);
-		tmp->tapi_h = NULL;
+	/* The high lane is drained at once, the low one yields between events */
+	do {
+		g_mutex_lock(&handle_data->noti_mutex);
+		lane_event = g_queue_pop_head(&lane->events);
+		if (lane_event == NULL) {
+			g_source_unref(lane->source);
+			lane->source = NULL;
+			lane->overflowed = FALSE;
+			g_mutex_unlock(&handle_data->noti_mutex);
+			return FALSE;
+		}
+		g_mutex_unlock(&handle_data->noti_mutex);
 
-		/* De-register all registered events */
-		g_slist_free_full(tmp->evt_list, _deregister_noti);
-		tmp->evt_list = NULL;
+		_noti_deliver(handle_data, lane_event->idx, &lane_event->payload);
+		_lane_event_free(lane_event);
 
-		/* Free handle[i] */
-		g_free(list->handle[i]);
+		/* A callback may have deinitialized the handle */
+		if (g_source_is_destroyed(source))
+			return FALSE;
+	} while (lane_id == NOTI_LANE_HIGH);
+
+	return TRUE;
+}
+
+static void _noti_lanes_init(telephony_data *data)
+{
+	int i;
+
+	for (i = 0; i < NOTI_LANE_MAX; i++) {
+		g_queue_init(&data->noti_lanes[i].events);
+		data->noti_lanes[i].source = NULL;
+		data->noti_lanes[i].lane_id = i;
+		data->noti_lanes[i].handle_data = data;
+		data->noti_lanes[i].capacity = noti_lane_default_policy[i].capacity;
+		data->noti_lanes[i].overflow = noti_lane_default_policy[i].overflow;
+		data->noti_lanes[i].high_water = 0;
+		data->noti_lanes[i].dropped = 0;
+		data->noti_lanes[i].overflowed = FALSE;
+	}
+}
+
+/* Must be called with noti_mutex held, pending events are discarded */
+static void _noti_lanes_clear(telephony_data *data)
+{
+	int i;
+
+	for (i = 0; i < NOTI_LANE_MAX; i++) {
+		telephony_noti_lane *lane = &data->noti_lanes[i];
+
+		if (lane->source) {
+			g_source_destroy(lane->source);
+			g_source_unref(lane->source);
+			lane->source = NULL;
+		}
+		g_queue_clear_full(&lane->events, (GDestroyNotify)_lane_event_free);
+	}
+}
+
+static void _record_event(telephony_data *handle_data, const char *evt_id,
+	const telephony_evt_payload *payload)
+{
+	telephony_noti_record record;
+
+	record.timestamp = payload->timestamp;
+	record.handle_index = handle_data->handle_index;
+	record.evt_id = evt_id;
+	record.type = payload->type;
+	record.value = payload->type == EVT_PAYLOAD_HANDLE_ID ?
+		(gint)payload->value.handle_id : payload->value.int_value;
+	record.call_state = payload->call_state;
+	record.string = payload->type == EVT_PAYLOAD_STRING ? payload->value.string : NULL;
+	_telephony_noti_recorder_append(&record);
+}
+
+void _telephony_noti_replay_record(telephony_data *data, const telephony_noti_record *record)
+{
+	telephony_evt_payload payload;
+	int idx;
+
+	idx = GPOINTER_TO_INT(g_hash_table_lookup(_get_evt_dispatch_map(), record->evt_id)) - 1;
+	if (idx < 0) {
+		LOGE("Unhandled noti: [%s]", record->evt_id);
+		return;
+	}
+
+	payload.type = record->type;
+	if (payload.type == EVT_PAYLOAD_HANDLE_ID)
+		payload.value.handle_id = (unsigned int)record->value;
+	else if (payload.type == EVT_PAYLOAD_STRING)
+		payload.value.string = record->string;
+	else
+		payload.value.int_value = record->value;
+	payload.call_state = record->call_state;
+	/* Recorded times belong to another boot, latencies are measured from now */
+	payload.timestamp = g_get_monotonic_time();
+	/* In turn with the live events, through the same lanes */
+	_noti_lane_push(data, idx, &payload);
+}
+
+static void on_signal_callback(TapiHandle *tapi_h, const char *evt_id,
+	void *data, void *user_data)
+{
+	telephony_data *handle_data = user_data;
+	telephony_evt_payload payload;
+	int idx;
+
+	if (handle_data == NULL) {
+		LOGE("handle is NULL");
+		return;
+	}
+
+	idx = GPOINTER_TO_INT(g_hash_table_lookup(_get_evt_dispatch_map(), evt_id)) - 1;
+	if (idx < 0) {
+		LOGE("Unhandled noti: [%s]", evt_id);
+		return;
+	}
+
+	/* Decoded once, whatever the number of subscribers */
+	payload.timestamp = g_get_monotonic_time();
+	payload.call_state = TELEPHONY_CALL_STATE_IDLE;
+	evt_dispatch_tbl[idx].decode(data, &payload);
+	if (evt_dispatch_tbl[idx].call_status)
+		_telephony_call_table_get_state_for_event(handle_data, evt_id,
+			payload.value.handle_id, &payload.call_state);
+	if (_telephony_noti_recorder_is_active())
+		_record_event(handle_data, evt_id, &payload);
+	_noti_lane_push(handle_data, idx, &payload);
+}
+
+static gboolean _has_subscribers(telephony_data *handle_data, const char *evt_id)
+{
+	gboolean found;
+
+	g_mutex_lock(&handle_data->noti_mutex);
+	found = handle_data->noti_events && g_hash_table_lookup(handle_data->noti_events, evt_id);
+	g_mutex_unlock(&handle_data->noti_mutex);
+
+	return found;
+}
+
+void _telephony_noti_dispatch_call_status(telephony_data *data,
+	const char *evt_id, unsigned int call_id)
+{
+	telephony_evt_payload payload;
+	gboolean recording = _telephony_noti_recorder_is_active();
+	int idx;
+
+	idx = GPOINTER_TO_INT(g_hash_table_lookup(_get_evt_dispatch_map(), evt_id)) - 1;
+	if (idx < 0)
+		return;
+
+	/* The call table sees every call event, most of them have nobody to go to */
+	if (!recording && !_has_subscribers(data, evt_id))
+		return;
+
+	payload.type = EVT_PAYLOAD_HANDLE_ID;
+	payload.value.handle_id = call_id;
+	payload.timestamp = g_get_monotonic_time();
+	/* Applies the event, which the table has usually applied already and then leaves unchanged */
+	_telephony_call_table_get_state_for_event(data, evt_id, call_id, &payload.call_state);
+	if (recording)
+		_record_event(data, evt_id, &payload);
+	_noti_lane_push(data, idx, &payload);
+}
+
+/* With fresh_only, only subscribers that missed the latest value get payload */
+static void _dispatch_to_subscribers(telephony_data *handle_data,
+	const char *evt_id, const telephony_evt_payload *payload, gboolean fresh_only)
+{
+	telephony_noti_event *noti_event;
+	telephony_evt_cb_data *subscribers[TELEPHONY_NOTI_SUBSCRIBERS_ON_STACK];
+	telephony_evt_cb_data **snapshot = subscribers;
+	guint count = 0;
+	guint i;
+	GSList *list;
+
+	/*
+	 * Callbacks are called without the lock held, on a snapshot of the
+	 * subscribers, so that they may subscribe or unsubscribe themselves.
+	 */
+	g_mutex_lock(&handle_data->noti_mutex);
+	noti_event = g_hash_table_lookup(handle_data->noti_events, evt_id);
+	if (noti_event) {
+		count = g_slist_length(noti_event->subscribers);
+		if (count > TELEPHONY_NOTI_SUBSCRIBERS_ON_STACK)
+			snapshot = g_new(telephony_evt_cb_data *, count);
+		for (i = 0, list = noti_event->subscribers; list; list = list->next, i++) {
+			snapshot[i] = list->data;
+			g_atomic_int_inc(&snapshot[i]->ref_count);
+		}
+	}
+	g_mutex_unlock(&handle_data->noti_mutex);
+
+	for (i = 0; i < count; i++) {
+		gboolean fresh = g_atomic_int_compare_and_exchange(&snapshot[i]->fresh, TRUE, FALSE);
+
+		if (!g_atomic_int_get(&snapshot[i]->removed) && (fresh || !fresh_only))
+			_dispatch_event(snapshot[i], evt_id, payload);
+		_evt_cb_data_unref(snapshot[i]);
+	}
+	if (snapshot != subscribers)
+		g_free(snapshot);
+}
+
+/* Must be called with noti_mutex held */
+static int _noti_event_subscribe(telephony_data *handle_data,
+	const char *evt_id, telephony_evt_cb_data *evt_cb_data)
+{
+	telephony_noti_event *noti_event;
+	int ret, idx;
+
+	noti_event = g_hash_table_lookup(handle_data->noti_events, evt_id);
+	if (noti_event == NULL) {
+		/* First subscriber of this event on this handle */
+		gboolean tapi_registered = !(_is_call_status_event(evt_id)
+			&& handle_data->call_table.call_signal_id);
+
+		if (tapi_registered) {
+			ret = tel_register_noti_event(handle_data->tapi_h, evt_id, on_signal_callback, handle_data);
+			if (ret != TAPI_API_SUCCESS) {
+				LOGE("Noti [%s] registration failed", evt_id);
+				return ret;
+			}
+		}
+		noti_event = g_new0(telephony_noti_event, 1);
+		noti_event->evt_id = evt_id;
+		noti_event->tapi_registered = tapi_registered;
+		g_hash_table_insert(handle_data->noti_events, (gpointer)evt_id, noti_event);
+	}
+	noti_event->subscribers = g_slist_append(noti_event->subscribers, evt_cb_data);
+
+	/*
+	 * The next value is a change for the new subscriber, even if repeated.
+	 * The filter state is shared, so the other subscribers still skip it.
+	 */
+	idx = GPOINTER_TO_INT(g_hash_table_lookup(_get_evt_dispatch_map(), evt_id)) - 1;
+	if (idx >= 0)
+		g_atomic_int_set(&evt_cb_data->fresh, TRUE);
+
+	return TAPI_API_SUCCESS;
+}
+
+/* Must be called with noti_mutex held */
+static void _noti_event_unsubscribe(telephony_data *handle_data,
+	const char *evt_id, telephony_evt_cb_data *evt_cb_data)
+{
+	telephony_noti_event *noti_event;
+	int ret;
+
+	noti_event = g_hash_table_lookup(handle_data->noti_events, evt_id);
+	if (noti_event == NULL)
+		return;
+
+	noti_event->subscribers = g_slist_remove(noti_event->subscribers, evt_cb_data);
+	if (noti_event->subscribers == NULL) {
+		/* Last subscriber of this event on this handle */
+		if (noti_event->tapi_registered) {
+			ret = tel_deregister_noti_event(handle_data->tapi_h, evt_id);
+			if (ret != TAPI_API_SUCCESS)
+				LOGE("Noti [%s] deregistration failed", evt_id);
+		}
+		g_hash_table_remove(handle_data->noti_events, evt_id);
+	}
+}
+
+/* Must be called with noti_mutex held */
+static void _noti_unsubscribe(telephony_data *handle_data, telephony_evt_cb_data *evt_cb_data,
+	const char **evts, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+		_noti_event_unsubscribe(handle_data, evts[i], evt_cb_data);
+
+	handle_data->noti_subs[evt_cb_data->noti_id] =
+		g_slist_remove(handle_data->noti_subs[evt_cb_data->noti_id], evt_cb_data);
+	g_atomic_int_set(&evt_cb_data->removed, TRUE);
+	_evt_cb_data_unref(evt_cb_data);
+}
+
+/* Must be called with noti_mutex held, noti_id must be supported */
+static int _noti_subscribe(telephony_data *handle_data, telephony_noti_e noti_id,
+	telephony_noti_cb cb, void *user_data, const telephony_noti_policy_s *policy,
+	const telephony_noti_sink *sink)
+{
+	telephony_evt_cb_data *evt_cb_data;
+	const char *single = NULL;
+	const char **evts;
+	int ret = TAPI_API_SUCCESS;
+	int count = 0, i;
+
+	evts = _get_noti_events(noti_id, &single, &count);
+
+	/* Make evt_cb_data */
+	evt_cb_data = g_new0(telephony_evt_cb_data, 1);
+	evt_cb_data->handle = (telephony_h)handle_data;
+	evt_cb_data->noti_id = noti_id;
+	evt_cb_data->cb = cb;
+	evt_cb_data->user_data = user_data;
+	if (policy)
+		evt_cb_data->policy = *policy;
+	if (sink && sink->queue)
+		evt_cb_data->queue = _telephony_event_queue_ref(sink->queue);
+	if (sink && sink->batch)
+		evt_cb_data->batch = _telephony_noti_batch_ref(sink->batch);
+	evt_cb_data->ref_count = 1;
+
+	for (i = 0; i < count; i++) {
+		ret = _noti_event_subscribe(handle_data, evts[i], evt_cb_data);
+		if (ret != TAPI_API_SUCCESS) {
+			/* Roll back the events already subscribed */
+			_noti_unsubscribe(handle_data, evt_cb_data, evts, i);
+			LOGE("Noti registration failed");
+			return TELEPHONY_ERROR_OPERATION_FAILED;
+		}
+	}
+	handle_data->noti_subs[noti_id] = g_slist_append(handle_data->noti_subs[noti_id], evt_cb_data);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+/* Must be called with noti_mutex held, removes the earliest subscription of noti_id */
+static void _noti_unsubscribe_first(telephony_data *handle_data, telephony_noti_e noti_id)
+{
+	const char *single = NULL;
+	const char **evts;
+	int count = 0;
+
+	if (handle_data->noti_subs[noti_id] == NULL)
+		return;
+
+	evts = _get_noti_events(noti_id, &single, &count);
+	_noti_unsubscribe(handle_data, handle_data->noti_subs[noti_id]->data, evts, count);
+	LOGI("De-registered noti_id: [%d]", noti_id);
+}
+
+static gboolean _is_deprecated_call_state_noti(telephony_noti_e noti_id)
+{
+	return noti_id == TELEPHONY_NOTI_VOICE_CALL_STATE
+		|| noti_id == TELEPHONY_NOTI_VIDEO_CALL_STATE;
+}
+
+static gboolean _is_supported_noti(telephony_noti_e noti_id)
+{
+	return _is_deprecated_call_state_noti(noti_id) || _mapping_noti_id(noti_id) != NULL;
+}
+
+void _telephony_noti_registry_init(telephony_data *data)
+{
+	g_mutex_init(&data->noti_mutex);
+	data->noti_events = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, g_free);
+	data->noti_last_values = g_new0(telephony_noti_last_value, EVT_DISPATCH_TBL_SIZE);
+	data->noti_callback_budget = TELEPHONY_NOTI_CALLBACK_BUDGET_DEFAULT;
+	_noti_lanes_init(data);
+}
+
+void _telephony_noti_registry_deinit(telephony_data *data)
+{
+	int noti_id;
+	guint i;
+
+	g_mutex_lock(&data->noti_mutex);
+	for (noti_id = 0; noti_id < TELEPHONY_NOTI_ID_MAX; noti_id++) {
+		while (data->noti_subs[noti_id])
+			_noti_unsubscribe_first(data, noti_id);
+	}
+	_noti_lanes_clear(data);
+	g_mutex_unlock(&data->noti_mutex);
+
+	g_hash_table_destroy(data->noti_events);
+	data->noti_events = NULL;
+	for (i = 0; i < EVT_DISPATCH_TBL_SIZE; i++)
+		g_free(data->noti_last_values[i].string);
+	g_free(data->noti_last_values);
+	data->noti_last_values = NULL;
+	g_mutex_clear(&data->noti_mutex);
+}
+
+/* Arguments of the subscription changes run on the dispatcher thread */
+typedef struct {
+	const telephony_noti_e *noti_ids;
+	unsigned int count;
+	telephony_noti_cb cb;
+	void *user_data;
+	const telephony_noti_policy_s *policy;
+	const telephony_noti_sink *sink;
+} telephony_noti_subscribe_args;
+
+static int _noti_subscribe_many(telephony_data *handle_data, gpointer user_data)
+{
+	telephony_noti_subscribe_args *args = user_data;
+	int ret = TELEPHONY_ERROR_NONE;
+	unsigned int i;
+
+	g_mutex_lock(&handle_data->noti_mutex);
+	for (i = 0; i < args->count; i++) {
+		ret = _noti_subscribe(handle_data, args->noti_ids[i],
+			args->cb, args->user_data, args->policy, args->sink);
+		if (ret != TELEPHONY_ERROR_NONE)
+			break;
 	}
+	if (ret != TELEPHONY_ERROR_NONE) {
+		/* Roll back, the latest subscriptions are at the end of each list */
+		while (i-- > 0) {
+			GSList *last = g_slist_last(handle_data->noti_subs[args->noti_ids[i]]);
+			const char *single = NULL;
+			const char **evts;
+			int evt_count = 0;
+
+			evts = _get_noti_events(args->noti_ids[i], &single, &evt_count);
+			_noti_unsubscribe(handle_data, last->data, evts, evt_count);
+		}
+	}
+	g_mutex_unlock(&handle_data->noti_mutex);
+
+	return ret;
+}
+
+static int _noti_unsubscribe_many(telephony_data *handle_data, gpointer user_data)
+{
+	telephony_noti_subscribe_args *args = user_data;
+	unsigned int i;
+
+	g_mutex_lock(&handle_data->noti_mutex);
+	for (i = 0; i < args->count; i++)
+		_noti_unsubscribe_first(handle_data, args->noti_ids[i]);
+	g_mutex_unlock(&handle_data->noti_mutex);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+int telephony_set_noti_cb(telephony_h handle,
+	telephony_noti_e noti_id, telephony_noti_cb cb, void *user_data)
+{
+	telephony_data *handle_data = (telephony_data *)handle;
+	telephony_noti_subscribe_args args;
+	int ret;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+
+	LOGI("Entry");
+
+	/* Mapping TAPI notification */
+	if (!_is_supported_noti(noti_id)) {
+		LOGE("Not supported noti_id");
+		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	}
+
+	args.noti_ids = &noti_id;
+	args.count = 1;
+	args.cb = cb;
+	args.user_data = user_data;
+	args.policy = NULL;
+	args.sink = NULL;
+	ret = _telephony_dispatcher_call(handle_data, _noti_subscribe_many, &args);
+
+	/* The deprecated call state is derived from the call table, see _dispatch_event() */
+	if (ret == TELEPHONY_ERROR_NONE && _is_deprecated_call_state_noti(noti_id))
+		_telephony_call_table_seed(handle_data);
+
+	return ret;
+}
+
+int telephony_unset_noti_cb(telephony_h handle, telephony_noti_e noti_id)
+{
+	telephony_data *handle_data = (telephony_data *)handle;
+	telephony_noti_subscribe_args args = { &noti_id, 1, NULL, NULL, NULL, NULL };
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+
+	LOGI("Entry");
+
+	if (!_is_supported_noti(noti_id)) {
+		LOGE("De-registration failed");
+		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	}
+
+	return _telephony_dispatcher_call(handle_data, _noti_unsubscribe_many, &args);
+}
+
+int telephony_set_noti_cb_with_policy(telephony_h handle, telephony_noti_e noti_id,
+	const telephony_noti_policy_s *policy, telephony_noti_cb cb, void *user_data)
+{
+	telephony_data *handle_data = (telephony_data *)handle;
+	telephony_noti_subscribe_args args;
+	int ret;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+	CHECK_INPUT_PARAMETER(policy);
+
+	LOGI("Entry, min_interval: [%u] ms, trailing_edge: [%d]",
+		policy->min_interval_ms, policy->trailing_edge);
+
+	if (!_is_supported_noti(noti_id)) {
+		LOGE("Not supported noti_id");
+		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	}
+
+	args.noti_ids = &noti_id;
+	args.count = 1;
+	args.cb = cb;
+	args.user_data = user_data;
+	args.policy = policy;
+	args.sink = NULL;
+	ret = _telephony_dispatcher_call(handle_data, _noti_subscribe_many, &args);
+
+	if (ret == TELEPHONY_ERROR_NONE && _is_deprecated_call_state_noti(noti_id))
+		_telephony_call_table_seed(handle_data);
+
+	return ret;
+}
+
+int telephony_get_noti_stats(telephony_h handle, telephony_noti_e noti_id,
+	telephony_noti_stats_s *stats)
+{
+	telephony_data *handle_data = (telephony_data *)handle;
+	telephony_noti_counters *counters;
+	int i;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+	CHECK_INPUT_PARAMETER(stats);
+
+	if (!_is_supported_noti(noti_id)) {
+		LOGE("Not supported noti_id");
+		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	}
+
+	counters = &handle_data->noti_stats[noti_id];
+	stats->delivered = (unsigned int)g_atomic_int_get(&counters->delivered);
+	stats->suppressed = (unsigned int)g_atomic_int_get(&counters->suppressed);
+	stats->filtered = (unsigned int)g_atomic_int_get(&counters->filtered);
+	stats->slow = (unsigned int)g_atomic_int_get(&counters->slow);
+	for (i = 0; i < TELEPHONY_NOTI_HISTOGRAM_BUCKETS; i++) {
+		stats->latency_histogram[i] = (unsigned int)g_atomic_int_get(&counters->latency[i]);
+		stats->duration_histogram[i] = (unsigned int)g_atomic_int_get(&counters->duration[i]);
+	}
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+int telephony_noti_get_timing(telephony_noti_timing_s *timing)
+{
+	telephony_noti_timing_s *current;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(timing);
+
+	current = g_private_get(&current_timing);
+	if (current == NULL) {
+		LOGE("Not called from a notification callback");
+		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	}
+	*timing = *current;
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+int telephony_set_noti_callback_budget(telephony_h handle, unsigned int budget_us)
+{
+	telephony_data *handle_data = (telephony_data *)handle;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+
+	if (budget_us == 0 || budget_us > G_MAXINT) {
+		LOGE("INVALID_PARAMETER");
+		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	}
+
+	LOGI("Entry, budget: [%u] us", budget_us);
+	g_atomic_int_set(&handle_data->noti_callback_budget, (gint)budget_us);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+int telephony_get_noti_slow_callbacks(telephony_h handle,
+	telephony_noti_slow_callback_s *callbacks, unsigned int max, unsigned int *count)
+{
+	telephony_data *handle_data = (telephony_data *)handle;
+	unsigned int i;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+	CHECK_INPUT_PARAMETER(callbacks);
+	CHECK_INPUT_PARAMETER(count);
+
+	g_mutex_lock(&handle_data->noti_mutex);
+	for (i = 0; i < handle_data->noti_slow_callback_count && i < max; i++)
+		callbacks[i] = handle_data->noti_slow_callbacks[i];
+	g_mutex_unlock(&handle_data->noti_mutex);
+	*count = i;
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+int telephony_set_noti_queue_policy(telephony_h handle, telephony_noti_class_e noti_class,
+	unsigned int capacity, telephony_noti_overflow_e overflow)
+{
+	telephony_data *handle_data = (telephony_data *)handle;
+	telephony_noti_lane *lane;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+
+	if ((guint)noti_class >= NOTI_LANE_MAX || capacity == 0
+			|| capacity > TELEPHONY_NOTI_QUEUE_CAPACITY_MAX
+			|| (overflow != TELEPHONY_NOTI_OVERFLOW_DROP_OLDEST
+				&& overflow != TELEPHONY_NOTI_OVERFLOW_NEVER_DROP)) {
+		LOGE("INVALID_PARAMETER");
+		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	}
+
+	LOGI("Entry, class: [%d], capacity: [%u], overflow: [%d]", noti_class, capacity, overflow);
+	g_mutex_lock(&handle_data->noti_mutex);
+	lane = &handle_data->noti_lanes[noti_class];
+	lane->capacity = capacity;
+	lane->overflow = overflow;
+	lane->overflowed = FALSE;
+	_noti_lane_trim(lane);
+	g_mutex_unlock(&handle_data->noti_mutex);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+int telephony_get_noti_queue_stats(telephony_h handle, telephony_noti_class_e noti_class,
+	telephony_noti_queue_stats_s *stats)
+{
+	telephony_data *handle_data = (telephony_data *)handle;
+	telephony_noti_lane *lane;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+	CHECK_INPUT_PARAMETER(stats);
+
+	if ((guint)noti_class >= NOTI_LANE_MAX) {
+		LOGE("INVALID_PARAMETER");
+		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	}
+
+	g_mutex_lock(&handle_data->noti_mutex);
+	lane = &handle_data->noti_lanes[noti_class];
+	stats->depth = lane->events.length;
+	stats->high_water = lane->high_water;
+	stats->dropped = lane->dropped;
+	g_mutex_unlock(&handle_data->noti_mutex);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+int telephony_set_noti_filter(telephony_h handle, bool enable)
+{
+	telephony_data *handle_data = (telephony_data *)handle;
+	guint i;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+
+	LOGI("Entry, enable: [%d]", enable);
+
+	g_mutex_lock(&handle_data->noti_mutex);
+	g_atomic_int_set(&handle_data->noti_filter_disabled, !enable);
+	/* Values seen while disabled were not remembered */
+	for (i = 0; i < EVT_DISPATCH_TBL_SIZE; i++)
+		handle_data->noti_last_values[i].valid = FALSE;
+	g_mutex_unlock(&handle_data->noti_mutex);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+int telephony_set_noti_cb_many(telephony_h handle, const telephony_noti_e *noti_ids,
+	unsigned int count, telephony_noti_cb cb, void *user_data)
+{
+	telephony_data *handle_data = (telephony_data *)handle;
+	telephony_noti_subscribe_args args;
+	gboolean seed_call_table = FALSE;
+	int ret;
+	unsigned int i;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+	CHECK_INPUT_PARAMETER(noti_ids);
+
+	LOGI("Entry, count: [%u]", count);
+
+	/* Nothing is set unless every noti_id is supported */
+	for (i = 0; i < count; i++) {
+		if (!_is_supported_noti(noti_ids[i])) {
+			LOGE("Not supported noti_id: [%d]", noti_ids[i]);
+			return TELEPHONY_ERROR_INVALID_PARAMETER;
+		}
+		if (_is_deprecated_call_state_noti(noti_ids[i]))
+			seed_call_table = TRUE;
+	}
+
+	args.noti_ids = noti_ids;
+	args.count = count;
+	args.cb = cb;
+	args.user_data = user_data;
+	args.policy = NULL;
+	args.sink = NULL;
+	ret = _telephony_dispatcher_call(handle_data, _noti_subscribe_many, &args);
+
+	if (ret == TELEPHONY_ERROR_NONE && seed_call_table)
+		_telephony_call_table_seed(handle_data);
+
+	return ret;
+}
+
+int telephony_unset_noti_cb_many(telephony_h handle, const telephony_noti_e *noti_ids,
+	unsigned int count)
+{
+	telephony_data *handle_data = (telephony_data *)handle;
+	telephony_noti_subscribe_args args = { noti_ids, count, NULL, NULL, NULL, NULL };
+	unsigned int i;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+	CHECK_INPUT_PARAMETER(noti_ids);
+
+	LOGI("Entry, count: [%u]", count);
+
+	for (i = 0; i < count; i++) {
+		if (!_is_supported_noti(noti_ids[i])) {
+			LOGE("Not supported noti_id: [%d]", noti_ids[i]);
+			return TELEPHONY_ERROR_INVALID_PARAMETER;
+		}
+	}
+
+	return _telephony_dispatcher_call(handle_data, _noti_unsubscribe_many, &args);
+}
+
+static int _noti_unsubscribe_sink(telephony_data *handle_data, gpointer user_data)
+{
+	const telephony_noti_sink *sink = user_data;
+	int noti_id;
+
+	g_mutex_lock(&handle_data->noti_mutex);
+	for (noti_id = 0; noti_id < TELEPHONY_NOTI_ID_MAX; noti_id++) {
+		GSList *list = handle_data->noti_subs[noti_id];
+
+		while (list) {
+			telephony_evt_cb_data *evt_cb_data = list->data;
+
+			list = list->next;
+			if ((sink->queue && evt_cb_data->queue == sink->queue)
+					|| (sink->batch && evt_cb_data->batch == sink->batch)) {
+				const char *single = NULL;
+				const char **evts;
+				int evt_count = 0;
+
+				evts = _get_noti_events(noti_id, &single, &evt_count);
+				_noti_unsubscribe(handle_data, evt_cb_data, evts, evt_count);
+			}
+		}
+	}
+	g_mutex_unlock(&handle_data->noti_mutex);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+int _telephony_noti_subscribe_sink(telephony_data *data, const telephony_noti_e *noti_ids,
+	unsigned int count, const telephony_noti_sink *sink)
+{
+	telephony_noti_subscribe_args args = { noti_ids, count, NULL, NULL, NULL, sink };
+	gboolean seed_call_table = FALSE;
+	int ret;
+	unsigned int i;
+
+	for (i = 0; i < count; i++) {
+		if (!_is_supported_noti(noti_ids[i])) {
+			LOGE("Not supported noti_id: [%d]", noti_ids[i]);
+			return TELEPHONY_ERROR_INVALID_PARAMETER;
+		}
+		if (_is_deprecated_call_state_noti(noti_ids[i]))
+			seed_call_table = TRUE;
+	}
+
+	ret = _telephony_dispatcher_call(data, _noti_subscribe_many, &args);
+
+	if (ret == TELEPHONY_ERROR_NONE && seed_call_table)
+		_telephony_call_table_seed(data);
+
+	return ret;
+}
+
+void _telephony_noti_unsubscribe_sink(telephony_data *data, const telephony_noti_sink *sink)
+{
+	_telephony_dispatcher_call(data, _noti_unsubscribe_sink, (gpointer)sink);
+}
+
+static void _on_telephony_daemon_vanished(GDBusConnection *connection,
+	const gchar *name, gpointer user_data)
+{
+	telephony_data *data = user_data;
+
+	/* Cached values are no longer trusted once the daemon is gone */
+	LOGI("[%s] vanished, drop cached values", name);
+	_telephony_network_cache_invalidate(data);
+	_telephony_sim_cache_invalidate(data);
+	_telephony_call_table_invalidate(data);
+}
+
+/*
+ * Signal subscriptions are bound to the main context of the thread making
+ * them, so they are made from the dispatcher thread when there is one
+ */
+static int _telephony_handle_setup(telephony_data *data, gpointer user_data)
+{
+	_telephony_network_cache_init(data);
+	_telephony_sim_cache_init(data);
+	_telephony_call_table_init(data);
+
+	data->name_watch_id = g_bus_watch_name_on_connection(data->tapi_h->dbus_connection,
+		DBUS_TELEPHONY_SERVICE, G_BUS_NAME_WATCHER_FLAGS_NONE,
+		NULL, _on_telephony_daemon_vanished, data, NULL);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+static int _telephony_handle_teardown(telephony_data *data, gpointer user_data)
+{
+	/* Drop cached values before the D-Bus connection goes away */
+	if (data->name_watch_id) {
+		g_bus_unwatch_name(data->name_watch_id);
+		data->name_watch_id = 0;
+	}
+
+	_telephony_network_cache_deinit(data);
+	_telephony_sim_cache_deinit(data);
+	_telephony_call_table_deinit(data);
+
+	/* Replayed events must not reach the handle anymore */
+	_telephony_noti_replay_cancel(data);
+
+	/* De-register all registered events */
+	_telephony_noti_registry_deinit(data);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+static void _telephony_handle_destroy(telephony_data *data)
+{
+	_telephony_dispatcher_call(data, _telephony_handle_teardown, NULL);
+
+	/* De-init TapiHandle */
+	tel_deinit(data->tapi_h);
+	data->tapi_h = NULL;
+
+	/* No callback of this handle can run once its subscriptions are gone */
+	if (data->dispatcher)
+		_telephony_dispatcher_unref(data->dispatcher);
+	g_main_context_unref(data->context);
+
+	g_free(data);
+}
+
+static int _telephony_init(telephony_handle_list_s *list, gboolean with_dispatcher)
+{
+	telephony_dispatcher *dispatcher = NULL;
+	char **cp_list;
+	int cp_count = 0;
+	int i;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(list);
+
+#if !GLIB_CHECK_VERSION(2, 35, 0)
+	/* Need g_type_init() to use tel_get_cp_name_list() */
+	g_type_init();
+#endif
+
+	cp_list = tel_get_cp_name_list();
+	if (cp_list == NULL) {
+		LOGE("cp_list is NULL");
+		return TELEPHONY_ERROR_OPERATION_FAILED;
+	}
+
+	while (cp_list[cp_count])
+		cp_count++;
+
+	/* Build the notification dispatch table before any event can arrive */
+	_get_evt_dispatch_map();
+
+	/* Every handle of the list shares the same dispatcher thread */
+	if (with_dispatcher) {
+		dispatcher = _telephony_dispatcher_new();
+		if (dispatcher == NULL) {
+			g_strfreev(cp_list);
+			return TELEPHONY_ERROR_OPERATION_FAILED;
+		}
+	}
+
+	list->count = cp_count;
+	list->handle = g_malloc(cp_count * sizeof(telephony_h));
+	for (i = 0; i < cp_count; i++) {
+		telephony_data *tmp = g_new0(telephony_data, 1);
+		tmp->tapi_h = tel_init(cp_list[i]);
+		if (tmp->tapi_h == NULL) {
+			int j = 0;
+			LOGE("handle is NULL");
+			for (; j < i; j++) {
+				/* Need to free already allocated data */
+				if (list->handle[j])
+					_telephony_handle_destroy((telephony_data *)list->handle[j]);
+			}
+			if (dispatcher)
+				_telephony_dispatcher_unref(dispatcher);
+			g_free(tmp);
+			g_free(list->handle);
+			list->handle = NULL;
+			list->count = 0;
+			g_strfreev(cp_list);
+			return TELEPHONY_ERROR_OPERATION_FAILED;
+		}
+		if (dispatcher) {
+			tmp->dispatcher = _telephony_dispatcher_ref(dispatcher);
+			tmp->context = g_main_context_ref(_telephony_dispatcher_get_context(dispatcher));
+		} else {
+			tmp->context = g_main_context_ref_thread_default();
+		}
+		tmp->handle_index = i;
+		_telephony_noti_registry_init(tmp);
+		_telephony_dispatcher_call(tmp, _telephony_handle_setup, NULL);
+		list->handle[i] = (telephony_h)tmp;
+	}
+	g_strfreev(cp_list);
+
+	/* Each handle holds its own reference from now on */
+	if (dispatcher)
+		_telephony_dispatcher_unref(dispatcher);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+int telephony_init(telephony_handle_list_s *list)
+{
+	return _telephony_init(list, FALSE);
+}
+
+int telephony_init_with_dispatcher(telephony_handle_list_s *list)
+{
+	return _telephony_init(list, TRUE);
+}
+
+int telephony_deinit(telephony_handle_list_s *list)
+{
+	unsigned int i;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(list);
+
+	for (i = 0; i < list->count; i++)
+		_telephony_handle_destroy((telephony_data *)list->handle[i]);
 	g_free(list->handle);
 	list->handle = NULL;
 	list->count = 0;
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2014 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <glib.h>
+#include <dlog.h>
+
+#include "telephony_common.h"
+#include "telephony_private.h"
+
+/*
+ * Library owned thread running a private GMainContext.
+ * Signal subscriptions made from this thread are delivered on it, so the
+ * notifications of the handles using it do not depend on the application
+ * main loop.
+ */
+struct _telephony_dispatcher {
+	gint ref_count;
+	GMainContext *context;
+	GMainLoop *loop;
+	GThread *thread;
+};
+
+typedef struct {
+	telephony_data *data;
+	telephony_dispatch_func func;
+	gpointer user_data;
+	int ret;
+	gboolean done;
+	GMutex mutex;
+	GCond cond;
+} telephony_dispatch_call;
+
+static gpointer _dispatcher_thread(gpointer user_data)
+{
+	telephony_dispatcher *dispatcher = user_data;
+	GMainContext *context = dispatcher->context;
+	GMainLoop *loop = dispatcher->loop;
+
+	g_main_context_push_thread_default(context);
+	g_main_loop_run(loop);
+	g_main_context_pop_thread_default(context);
+
+	/* The dispatcher itself may be gone already, see _telephony_dispatcher_unref() */
+	g_main_loop_unref(loop);
+	g_main_context_unref(context);
+
+	return NULL;
+}
+
+telephony_dispatcher *_telephony_dispatcher_new(void)
+{
+	telephony_dispatcher *dispatcher;
+	GError *error = NULL;
+
+	dispatcher = g_new0(telephony_dispatcher, 1);
+	dispatcher->ref_count = 1;
+	dispatcher->context = g_main_context_new();
+	dispatcher->loop = g_main_loop_new(dispatcher->context, FALSE);
+
+	/* The thread owns a reference of the loop and of the context */
+	g_main_loop_ref(dispatcher->loop);
+	g_main_context_ref(dispatcher->context);
+	dispatcher->thread = g_thread_try_new("telephony-dispatcher",
+		_dispatcher_thread, dispatcher, &error);
+	if (dispatcher->thread == NULL) {
+		LOGE("Dispatcher thread creation failed (%s)", error ? error->message : "");
+		g_clear_error(&error);
+		g_main_loop_unref(dispatcher->loop);
+		g_main_loop_unref(dispatcher->loop);
+		g_main_context_unref(dispatcher->context);
+		g_main_context_unref(dispatcher->context);
+		g_free(dispatcher);
+		return NULL;
+	}
+
+	return dispatcher;
+}
+
+telephony_dispatcher *_telephony_dispatcher_ref(telephony_dispatcher *dispatcher)
+{
+	g_atomic_int_inc(&dispatcher->ref_count);
+	return dispatcher;
+}
+
+GMainContext *_telephony_dispatcher_get_context(telephony_dispatcher *dispatcher)
+{
+	return dispatcher->context;
+}
+
+static gboolean _dispatcher_quit_cb(gpointer user_data)
+{
+	g_main_loop_quit(user_data);
+	return FALSE;
+}
+
+void _telephony_dispatcher_unref(telephony_dispatcher *dispatcher)
+{
+	if (!g_atomic_int_dec_and_test(&dispatcher->ref_count))
+		return;
+
+	/*
+	 * Quitting from a source of the context also works when the loop has
+	 * not started running yet
+	 */
+	g_main_context_invoke(dispatcher->context, _dispatcher_quit_cb, dispatcher->loop);
+
+	if (g_thread_self() == dispatcher->thread) {
+		/* Released from a callback, the thread ends once it returns */
+		g_thread_unref(dispatcher->thread);
+	} else {
+		g_thread_join(dispatcher->thread);
+	}
+
+	g_main_loop_unref(dispatcher->loop);
+	g_main_context_unref(dispatcher->context);
+	g_free(dispatcher);
+}
+
+static gboolean _dispatch_call_cb(gpointer user_data)
+{
+	telephony_dispatch_call *call = user_data;
+
+	call->ret = call->func(call->data, call->user_data);
+
+	g_mutex_lock(&call->mutex);
+	call->done = TRUE;
+	g_cond_signal(&call->cond);
+	g_mutex_unlock(&call->mutex);
+
+	return FALSE;
+}
+
+int _telephony_dispatcher_call(telephony_data *data,
+	telephony_dispatch_func func, gpointer user_data)
+{
+	telephony_dispatch_call call;
+
+	if (data->dispatcher == NULL || g_main_context_is_owner(data->dispatcher->context))
+		return func(data, user_data);
+
+	call.data = data;
+	call.func = func;
+	call.user_data = user_data;
+	call.ret = TELEPHONY_ERROR_NONE;
+	call.done = FALSE;
+	g_mutex_init(&call.mutex);
+	g_cond_init(&call.cond);
+
+	g_main_context_invoke_full(data->dispatcher->context, G_PRIORITY_HIGH,
+		_dispatch_call_cb, &call, NULL);
+
+	g_mutex_lock(&call.mutex);
+	while (!call.done)
+		g_cond_wait(&call.cond, &call.mutex);
+	g_mutex_unlock(&call.mutex);
+
+	g_cond_clear(&call.cond);
+	g_mutex_clear(&call.mutex);
+
+	return call.ret;
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2014 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <glib.h>
+#include <dlog.h>
+
+#include "telephony_common.h"
+#include "telephony_private.h"
+
+/*
+ * Single producer, single consumer ring of events.
+ * The producer is the thread dispatching the notifications of the handle,
+ * the consumer is the thread calling telephony_event_poll(). head and tail
+ * are free running counters, each written by one side only.
+ */
+struct _telephony_event_queue_s {
+	gint ref_count; /* Held by the application and by each subscription */
+	telephony_data *handle_data;
+	int fd; /* eventfd, readable while the ring may hold events */
+	guint capacity; /* Power of two */
+	gint head; /* Next event to read, written by the consumer */
+	gint tail; /* Next event to write, written by the producer */
+	gint dropped;
+	telephony_event_s events[];
+};
+
+telephony_event_queue_h _telephony_event_queue_ref(telephony_event_queue_h queue)
+{
+	g_atomic_int_inc(&queue->ref_count);
+	return queue;
+}
+
+void _telephony_event_queue_unref(telephony_event_queue_h queue)
+{
+	if (!g_atomic_int_dec_and_test(&queue->ref_count))
+		return;
+
+	close(queue->fd);
+	g_free(queue);
+}
+
+static void _event_queue_signal(telephony_event_queue_h queue)
+{
+	uint64_t one = 1;
+
+	if (write(queue->fd, &one, sizeof(one)) != sizeof(one))
+		LOGE("eventfd write failed");
+}
+
+void _telephony_event_queue_push(telephony_event_queue_h queue, const telephony_event_s *event)
+{
+	guint tail = (guint)queue->tail; /* Only written by this side */
+	guint head = (guint)g_atomic_int_get(&queue->head);
+
+	if (tail - head >= queue->capacity) {
+		if (g_atomic_int_add(&queue->dropped, 1) == 0)
+			LOGE("Event queue is full, dropping events");
+		return;
+	}
+
+	queue->events[tail & (queue->capacity - 1)] = *event;
+	/* Full barrier, the head is read again only after the event is published */
+	g_atomic_int_add(&queue->tail, 1);
+
+	/* Only the first pending event needs a wakeup, see telephony_event_poll() */
+	if (tail == (guint)g_atomic_int_get(&queue->head))
+		_event_queue_signal(queue);
+}
+
+int telephony_event_queue_create(telephony_h handle, const telephony_noti_e *noti_ids,
+	unsigned int count, unsigned int capacity, telephony_event_queue_h *queue)
+{
+	telephony_event_queue_h tmp;
+	telephony_noti_sink sink = { NULL, NULL };
+	guint size = 1;
+	int ret;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+	CHECK_INPUT_PARAMETER(noti_ids);
+	CHECK_INPUT_PARAMETER(queue);
+
+	if (count == 0 || capacity == 0 || capacity > TELEPHONY_EVENT_QUEUE_CAPACITY_MAX) {
+		LOGE("INVALID_PARAMETER");
+		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	}
+
+	while (size < capacity)
+		size <<= 1;
+
+	tmp = g_malloc0(sizeof(*tmp) + size * sizeof(telephony_event_s));
+	tmp->ref_count = 1;
+	tmp->handle_data = (telephony_data *)handle;
+	tmp->capacity = size;
+	tmp->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (tmp->fd < 0) {
+		LOGE("eventfd creation failed");
+		g_free(tmp);
+		return TELEPHONY_ERROR_OPERATION_FAILED;
+	}
+
+	sink.queue = tmp;
+	ret = _telephony_noti_subscribe_sink(tmp->handle_data, noti_ids, count, &sink);
+	if (ret != TELEPHONY_ERROR_NONE) {
+		_telephony_event_queue_unref(tmp);
+		return ret;
+	}
+
+	*queue = tmp;
+	LOGI("Event queue created, capacity: [%u]", size);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+int telephony_event_queue_destroy(telephony_event_queue_h queue)
+{
+	telephony_noti_sink sink = { NULL, NULL };
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(queue);
+
+	sink.queue = queue;
+	_telephony_noti_unsubscribe_sink(queue->handle_data, &sink);
+	if (g_atomic_int_get(&queue->dropped))
+		LOGI("Event queue destroyed, dropped events: [%d]", g_atomic_int_get(&queue->dropped));
+	_telephony_event_queue_unref(queue);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+int telephony_event_queue_get_fd(telephony_event_queue_h queue, int *fd)
+{
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(queue);
+	CHECK_INPUT_PARAMETER(fd);
+
+	*fd = queue->fd;
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+int telephony_event_poll(telephony_event_queue_h queue, telephony_event_s *events,
+	unsigned int max, unsigned int *count)
+{
+	uint64_t value;
+	guint head, tail;
+	unsigned int n = 0;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(queue);
+	CHECK_INPUT_PARAMETER(events);
+	CHECK_INPUT_PARAMETER(count);
+
+	/* Cleared before draining so that no wakeup of a later event is lost */
+	if (read(queue->fd, &value, sizeof(value)) < 0)
+		value = 0;
+
+	head = (guint)queue->head; /* Only written by this side */
+	tail = (guint)g_atomic_int_get(&queue->tail);
+	while (head + n != tail && n < max) {
+		events[n] = queue->events[(head + n) & (queue->capacity - 1)];
+		n++;
+	}
+	/* Full barrier, the tail is read again only after the slots are released */
+	g_atomic_int_add(&queue->head, (gint)n);
+	head += n;
+
+	/*
+	 * The producer only signals the first event of an empty ring, so keep
+	 * the descriptor readable while events are left
+	 */
+	if ((guint)g_atomic_int_get(&queue->tail) != head)
+		_event_queue_signal(queue);
+
+	*count = n;
+
+	return TELEPHONY_ERROR_NONE;
+}
@@ -30,6 +30,409 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#define DBUS_PROPERTIES_INTERFACE "org.freedesktop.DBus.Properties"
+
+#define NETWORK_PROP_BIT(prop) (1 << (prop))
+
+/* TAPI property of each telephony_network_prop_e, in the same order */
+static const char *network_prop_tbl[NETWORK_PROP_MAX] = {
+	TAPI_PROP_NETWORK_LAC,
+	TAPI_PROP_NETWORK_CELLID,
+	TAPI_PROP_NETWORK_SIGNALSTRENGTH_LEVEL,
+	TAPI_PROP_NETWORK_ROAMING_STATUS,
+	TAPI_PROP_NETWORK_PLMN,
+	TAPI_PROP_NETWORK_NETWORK_NAME,
+	TAPI_PROP_NETWORK_NAME_OPTION,
+	TAPI_PROP_NETWORK_SERVICE_TYPE,
+	TAPI_PROP_NETWORK_PS_TYPE
+};
+
+static gboolean _is_string_network_prop(int prop)
+{
+	return prop == NETWORK_PROP_PLMN || prop == NETWORK_PROP_NETWORK_NAME;
+}
+
+/* TAPI property names are "<dbus interface>:<dbus property>" */
+static int _find_network_prop(const char *interface, const char *name)
+{
+	size_t len = strlen(interface);
+	int i;
+
+	for (i = 0; i < NETWORK_PROP_MAX; i++) {
+		if (!strncmp(network_prop_tbl[i], interface, len)
+				&& network_prop_tbl[i][len] == ':'
+				&& !g_strcmp0(network_prop_tbl[i] + len + 1, name))
+			return i;
+	}
+
+	return -1;
+}
+
+/* PLMN is MCC (3 digits) followed by MNC (2 or 3 digits) */
+static void _parse_plmn(const char *plmn, char *mcc, char *mnc)
+{
+	mcc[0] = '\0';
+	mnc[0] = '\0';
+	if (plmn == NULL || strlen(plmn) < TELEPHONY_NETWORK_MCC_LEN_MAX)
+		return;
+
+	g_strlcpy(mcc, plmn, TELEPHONY_NETWORK_MCC_LEN_MAX + 1);
+	g_strlcpy(mnc, plmn + TELEPHONY_NETWORK_MCC_LEN_MAX, TELEPHONY_NETWORK_MNC_LEN_MAX + 1);
+}
+
+/* Must be called with cache->mutex held */
+static void _network_cache_set_string(telephony_network_cache *cache, int prop, const char *value)
+{
+	g_free(cache->str_value[prop]);
+	cache->str_value[prop] = g_strdup(value);
+
+	/* Parse the PLMN once here rather than on every MCC/MNC read */
+	if (prop == NETWORK_PROP_PLMN)
+		_parse_plmn(value, cache->plmn_mcc, cache->plmn_mnc);
+}
+
+/* Must be called with cache->mutex held */
+static void _network_cache_store(telephony_network_cache *cache, int prop, GVariant *value)
+{
+	if (_is_string_network_prop(prop)) {
+		if (!g_variant_is_of_type(value, G_VARIANT_TYPE_STRING))
+			return;
+		_network_cache_set_string(cache, prop, g_variant_get_string(value, NULL));
+	} else if (!_telephony_variant_get_int(value, &cache->int_value[prop])) {
+		LOGE("Unexpected type [%s] of [%s]", g_variant_get_type_string(value),
+			network_prop_tbl[prop]);
+		return;
+	}
+
+	cache->valid |= NETWORK_PROP_BIT(prop);
+}
+
+/* Network properties of a GetAll reply, see telephony_network_get_snapshot() */
+typedef struct {
+	guint valid; /* Bitmask of the telephony_network_prop_e in the reply */
+	int int_value[NETWORK_PROP_MAX];
+	char *str_value[NETWORK_PROP_MAX];
+} telephony_network_props;
+
+static void _network_props_store(telephony_network_props *props, int prop, GVariant *value)
+{
+	if (_is_string_network_prop(prop)) {
+		if (!g_variant_is_of_type(value, G_VARIANT_TYPE_STRING))
+			return;
+		g_free(props->str_value[prop]);
+		props->str_value[prop] = g_variant_dup_string(value, NULL);
+	} else if (!_telephony_variant_get_int(value, &props->int_value[prop])) {
+		LOGE("Unexpected type [%s] of [%s]", g_variant_get_type_string(value),
+			network_prop_tbl[prop]);
+		return;
+	}
+
+	props->valid |= NETWORK_PROP_BIT(prop);
+}
+
+/* Network properties recorded by the history */
+#define NETWORK_HISTORY_PROPS (NETWORK_PROP_BIT(NETWORK_PROP_LAC) \
+	| NETWORK_PROP_BIT(NETWORK_PROP_CELLID) \
+	| NETWORK_PROP_BIT(NETWORK_PROP_SIGNALSTRENGTH_LEVEL) \
+	| NETWORK_PROP_BIT(NETWORK_PROP_PLMN) \
+	| NETWORK_PROP_BIT(NETWORK_PROP_SERVICE_TYPE) \
+	| NETWORK_PROP_BIT(NETWORK_PROP_PS_TYPE))
+
+static void _network_history_apply(telephony_network_history_state *state,
+	const telephony_network_history_delta *delta)
+{
+	if (delta->prop == NETWORK_PROP_PLMN)
+		g_strlcpy(state->plmn, delta->value.plmn, sizeof(state->plmn));
+	else
+		state->int_value[delta->prop] = delta->value.int_value;
+	state->valid |= NETWORK_PROP_BIT(delta->prop);
+}
+
+static const telephony_network_history_delta *_network_history_get(
+	const telephony_network_history *history, guint index)
+{
+	return &history->deltas[(history->head + index) % history->capacity];
+}
+
+/* Records the cached value of prop if it changed, must be called with cache->mutex held */
+static void _network_history_update(telephony_network_cache *cache, int prop)
+{
+	telephony_network_history *history = &cache->history;
+	telephony_network_history_delta delta;
+
+	if (history->deltas == NULL || !(NETWORK_HISTORY_PROPS & NETWORK_PROP_BIT(prop)))
+		return;
+
+	memset(&delta, 0x00, sizeof(delta));
+	delta.timestamp = g_get_monotonic_time();
+	delta.prop = prop;
+	if (prop == NETWORK_PROP_PLMN) {
+		if (cache->str_value[prop])
+			g_strlcpy(delta.value.plmn, cache->str_value[prop], sizeof(delta.value.plmn));
+		if ((history->current.valid & NETWORK_PROP_BIT(prop))
+				&& !strcmp(history->current.plmn, delta.value.plmn))
+			return;
+	} else {
+		delta.value.int_value = cache->int_value[prop];
+		if ((history->current.valid & NETWORK_PROP_BIT(prop))
+				&& history->current.int_value[prop] == delta.value.int_value)
+			return;
+	}
+
+	/* Once full, the oldest change moves into the base state */
+	if (history->count == history->capacity) {
+		_network_history_apply(&history->base, _network_history_get(history, 0));
+		history->base_timestamp = _network_history_get(history, 0)->timestamp;
+		history->head = (history->head + 1) % history->capacity;
+		history->count--;
+	}
+	history->deltas[(history->head + history->count) % history->capacity] = delta;
+	history->count++;
+	_network_history_apply(&history->current, &delta);
+}
+
+static void _on_network_prop_changed(GDBusConnection *connection,
+	const gchar *sender_name, const gchar *object_path,
+	const gchar *interface_name, const gchar *signal_name,
+	GVariant *parameters, gpointer user_data)
+{
+	telephony_network_cache *cache = &((telephony_data *)user_data)->network_cache;
+	const gchar *prop_interface = NULL;
+	const gchar *key = NULL;
+	GVariant *value = NULL;
+	GVariantIter *changed = NULL;
+	GVariantIter *invalidated = NULL;
+	int prop;
+
+	g_variant_get(parameters, "(&sa{sv}as)", &prop_interface, &changed, &invalidated);
+
+	g_mutex_lock(&cache->mutex);
+	while (g_variant_iter_loop(changed, "{&sv}", &key, &value)) {
+		prop = _find_network_prop(prop_interface, key);
+		if (prop >= 0) {
+			_network_cache_store(cache, prop, value);
+			_network_history_update(cache, prop);
+		}
+	}
+	while (g_variant_iter_loop(invalidated, "&s", &key)) {
+		prop = _find_network_prop(prop_interface, key);
+		if (prop >= 0)
+			cache->valid &= ~NETWORK_PROP_BIT(prop);
+	}
+	cache->generation++;
+	g_mutex_unlock(&cache->mutex);
+
+	g_variant_iter_free(changed);
+	g_variant_iter_free(invalidated);
+}
+
+void _telephony_network_cache_init(telephony_data *data)
+{
+	telephony_network_cache *cache = &data->network_cache;
+
+	g_mutex_init(&cache->mutex);
+
+	/*
+	 * Values are cached only while this subscription is alive,
+	 * otherwise every read goes to the telephony daemon as before.
+	 */
+	cache->prop_changed_id = g_dbus_connection_signal_subscribe(
+		data->tapi_h->dbus_connection, DBUS_TELEPHONY_SERVICE,
+		DBUS_PROPERTIES_INTERFACE, "PropertiesChanged", data->tapi_h->path,
+		DBUS_TELEPHONY_NETWORK_INTERFACE, G_DBUS_SIGNAL_FLAGS_NONE,
+		_on_network_prop_changed, data, NULL);
+	if (cache->prop_changed_id == 0)
+		LOGE("Network property cache is disabled");
+}
+
+void _telephony_network_cache_invalidate(telephony_data *data)
+{
+	telephony_network_cache *cache = &data->network_cache;
+	int i;
+
+	g_mutex_lock(&cache->mutex);
+	for (i = 0; i < NETWORK_PROP_MAX; i++) {
+		g_free(cache->str_value[i]);
+		cache->str_value[i] = NULL;
+	}
+	cache->valid = 0;
+	cache->generation++;
+	g_mutex_unlock(&cache->mutex);
+}
+
+void _telephony_network_cache_deinit(telephony_data *data)
+{
+	telephony_network_cache *cache = &data->network_cache;
+
+	if (cache->prop_changed_id) {
+		g_dbus_connection_signal_unsubscribe(data->tapi_h->dbus_connection,
+			cache->prop_changed_id);
+		cache->prop_changed_id = 0;
+	}
+	_telephony_network_cache_invalidate(data);
+	g_free(cache->history.deltas);
+	cache->history.deltas = NULL;
+	g_mutex_clear(&cache->mutex);
+}
+
+/* Returns TAPI error code like tel_get_property_int() */
+static int _get_network_property_int(telephony_data *data,
+	telephony_network_prop_e prop, int *value)
+{
+	telephony_network_cache *cache = &data->network_cache;
+	guint generation;
+	int ret;
+
+	g_mutex_lock(&cache->mutex);
+	if (cache->valid & NETWORK_PROP_BIT(prop)) {
+		*value = cache->int_value[prop];
+		cache->hit_count++;
+		g_mutex_unlock(&cache->mutex);
+		return TAPI_API_SUCCESS;
+	}
+	cache->miss_count++;
+	generation = cache->generation;
+	g_mutex_unlock(&cache->mutex);
+
+	ret = tel_get_property_int(data->tapi_h, network_prop_tbl[prop], value);
+	if (ret == TAPI_API_SUCCESS) {
+		g_mutex_lock(&cache->mutex);
+		/* Do not overwrite a value which has changed while it was fetched */
+		if (cache->prop_changed_id && cache->generation == generation) {
+			cache->int_value[prop] = *value;
+			cache->valid |= NETWORK_PROP_BIT(prop);
+			_network_history_update(cache, prop);
+		}
+		g_mutex_unlock(&cache->mutex);
+	}
+
+	return ret;
+}
+
+/* Returns TAPI error code like tel_get_property_string() */
+static int _get_network_property_string(telephony_data *data,
+	telephony_network_prop_e prop, char **value)
+{
+	telephony_network_cache *cache = &data->network_cache;
+	guint generation;
+	int ret;
+
+	g_mutex_lock(&cache->mutex);
+	if (cache->valid & NETWORK_PROP_BIT(prop)) {
+		*value = g_strdup(cache->str_value[prop]);
+		cache->hit_count++;
+		g_mutex_unlock(&cache->mutex);
+		return TAPI_API_SUCCESS;
+	}
+	cache->miss_count++;
+	generation = cache->generation;
+	g_mutex_unlock(&cache->mutex);
+
+	ret = tel_get_property_string(data->tapi_h, network_prop_tbl[prop], value);
+	if (ret == TAPI_API_SUCCESS) {
+		g_mutex_lock(&cache->mutex);
+		/* Do not overwrite a value which has changed while it was fetched */
+		if (cache->prop_changed_id && cache->generation == generation) {
+			_network_cache_set_string(cache, prop, *value);
+			cache->valid |= NETWORK_PROP_BIT(prop);
+			_network_history_update(cache, prop);
+		}
+		g_mutex_unlock(&cache->mutex);
+	}
+
+	return ret;
+}
+
+/* Returns TAPI error code, MCC and MNC are parsed once per PLMN change */
+static int _get_network_plmn(telephony_data *data, char *mcc, char *mnc)
+{
+	telephony_network_cache *cache = &data->network_cache;
+	char *plmn = NULL;
+	int ret;
+
+	g_mutex_lock(&cache->mutex);
+	if (cache->valid & NETWORK_PROP_BIT(NETWORK_PROP_PLMN)) {
+		g_strlcpy(mcc, cache->plmn_mcc, TELEPHONY_NETWORK_MCC_LEN_MAX + 1);
+		g_strlcpy(mnc, cache->plmn_mnc, TELEPHONY_NETWORK_MNC_LEN_MAX + 1);
+		cache->hit_count++;
+		g_mutex_unlock(&cache->mutex);
+		return TAPI_API_SUCCESS;
+	}
+	g_mutex_unlock(&cache->mutex);
+
+	ret = _get_network_property_string(data, NETWORK_PROP_PLMN, &plmn);
+	if (ret == TAPI_API_SUCCESS) {
+		_parse_plmn(plmn, mcc, mnc);
+		free(plmn);
+	}
+
+	return ret;
+}
+
+static telephony_network_name_option_e _mapping_name_option(int name_option)
+{
+	switch (name_option) {
+	case TAPI_NETWORK_NAME_OPTION_SPN:
+		return TELEPHONY_NETWORK_NAME_OPTION_SPN;
+	case TAPI_NETWORK_NAME_OPTION_OPERATOR:
+		return TELEPHONY_NETWORK_NAME_OPTION_NETWORK;
+	case TAPI_NETWORK_NAME_OPTION_ANY:
+		return TELEPHONY_NETWORK_NAME_OPTION_ANY;
+	default:
+		return TELEPHONY_NETWORK_NAME_OPTION_UNKNOWN;
+	}
+}
+
+static telephony_network_type_e _mapping_network_type(int service_type)
+{
+	switch (service_type) {
+	case TAPI_NETWORK_SERVICE_TYPE_2G:
+		return TELEPHONY_NETWORK_TYPE_GSM;
+	case TAPI_NETWORK_SERVICE_TYPE_2_5G:
+		return TELEPHONY_NETWORK_TYPE_GPRS;
+	case TAPI_NETWORK_SERVICE_TYPE_2_5G_EDGE:
+		return TELEPHONY_NETWORK_TYPE_EDGE;
+	case TAPI_NETWORK_SERVICE_TYPE_3G:
+		return TELEPHONY_NETWORK_TYPE_UMTS;
+	case TAPI_NETWORK_SERVICE_TYPE_HSDPA:
+		return TELEPHONY_NETWORK_TYPE_HSDPA;
+	case TAPI_NETWORK_SERVICE_TYPE_LTE:
+		return TELEPHONY_NETWORK_TYPE_LTE;
+	default:
+		return TELEPHONY_NETWORK_TYPE_UNKNOWN;
+	}
+}
+
+static telephony_network_ps_type_e _mapping_ps_type(int ps_type)
+{
+	switch (ps_type) {
+	case TAPI_NETWORK_PS_TYPE_HSDPA:
+		return TELEPHONY_NETWORK_PS_TYPE_HSDPA;
+	case TAPI_NETWORK_PS_TYPE_HSUPA:
+		return TELEPHONY_NETWORK_PS_TYPE_HSUPA;
+	case TAPI_NETWORK_PS_TYPE_HSPA:
+		return TELEPHONY_NETWORK_PS_TYPE_HSPA;
+	case TAPI_NETWORK_PS_TYPE_HSPAP:
+		return TELEPHONY_NETWORK_PS_TYPE_HSPAP;
+	default:
+		return TELEPHONY_NETWORK_PS_TYPE_UNKNOWN;
+	}
+}
+
+static telephony_network_service_state_e _mapping_service_state(int service_type)
+{
+	switch (service_type) {
+	case TAPI_NETWORK_SERVICE_TYPE_UNKNOWN:
+	case TAPI_NETWORK_SERVICE_TYPE_NO_SERVICE:
+	case TAPI_NETWORK_SERVICE_TYPE_SEARCH:
+		return TELEPHONY_NETWORK_SERVICE_STATE_OUT_OF_SERVICE;
+	case TAPI_NETWORK_SERVICE_TYPE_EMERGENCY:
+		return TELEPHONY_NETWORK_SERVICE_STATE_EMERGENCY_ONLY;
+	default:
+		return TELEPHONY_NETWORK_SERVICE_STATE_IN_SERVICE;
+	}
+}
+
 int telephony_network_get_lac(telephony_h handle, int *lac)
 {
 	int ret;
@@ -41,7 +444,7 @@ int telephony_network_get_lac(telephony_h handle, int *lac)
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(lac);
 
-	ret = tel_get_property_int(tapi_h, TAPI_PROP_NETWORK_LAC, lac);
+	ret = _get_network_property_int((telephony_data *)handle, NETWORK_PROP_LAC, lac);
 	if (ret == TAPI_API_SUCCESS) {
 		LOGI("lac:[%d]", *lac);
 		ret = TELEPHONY_ERROR_NONE;
@@ -67,7 +470,7 @@ int telephony_network_get_cell_id(telephony_h handle, int *cell_id)
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(cell_id);
 
-	ret = tel_get_property_int(tapi_h, TAPI_PROP_NETWORK_CELLID, cell_id);
+	ret = _get_network_property_int((telephony_data *)handle, NETWORK_PROP_CELLID, cell_id);
 	if (ret == TAPI_API_SUCCESS) {
 		LOGI("cell_id:[%d]", *cell_id);
 		ret = TELEPHONY_ERROR_NONE;
@@ -93,7 +496,7 @@ int telephony_network_get_rssi(telephony_h handle, telephony_network_rssi_e *rss
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(rssi);
 
-	ret = tel_get_property_int(tapi_h, TAPI_PROP_NETWORK_SIGNALSTRENGTH_LEVEL, (int *)rssi);
+	ret = _get_network_property_int((telephony_data *)handle, NETWORK_PROP_SIGNALSTRENGTH_LEVEL, (int *)rssi);
 	if (ret == TAPI_API_SUCCESS) {
 		LOGI("rssi:[%d]", *rssi);
 		ret = TELEPHONY_ERROR_NONE;
@@ -120,7 +523,7 @@ int telephony_network_get_roaming_status(telephony_h handle, bool *status)
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(status);
 
-	ret = tel_get_property_int(tapi_h, TAPI_PROP_NETWORK_ROAMING_STATUS, &temp);
+	ret = _get_network_property_int((telephony_data *)handle, NETWORK_PROP_ROAMING_STATUS, &temp);
 	if (ret == TAPI_API_SUCCESS) {
 		if (temp == 1)
 			*status = true;
@@ -142,8 +545,8 @@ int telephony_network_get_roaming_status(telephony_h handle, bool *status)
 int telephony_network_get_mcc(telephony_h handle, char **mcc)
 {
 	int ret;
-	char *plmn_str = NULL;
-	int mcc_length = 3;
+	char plmn_mcc[TELEPHONY_NETWORK_MCC_LEN_MAX + 1];
+	char plmn_mnc[TELEPHONY_NETWORK_MNC_LEN_MAX + 1];
 	TapiHandle *tapi_h;
 
 	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
@@ -152,17 +555,13 @@ int telephony_network_get_mcc(telephony_h handle, char **mcc)
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(mcc);
 
-	ret = tel_get_property_string(tapi_h, TAPI_PROP_NETWORK_PLMN, &plmn_str);
+	ret = _get_network_plmn((telephony_data *)handle, plmn_mcc, plmn_mnc);
 	if (ret == TAPI_API_SUCCESS) {
-		*mcc = malloc(sizeof(char) * (mcc_length + 1));
+		*mcc = strdup(plmn_mcc);
 		if (*mcc == NULL) {
 			LOGE("OUT_OF_MEMORY");
 			ret = TELEPHONY_ERROR_OUT_OF_MEMORY;
 		} else {
-			memset(*mcc, 0x00, mcc_length + 1);
-			strncpy(*mcc, plmn_str, mcc_length);
-			free(plmn_str);
-
 			LOGI("mcc:[%s]", *mcc);
 			ret = TELEPHONY_ERROR_NONE;
 		}
@@ -180,8 +579,8 @@ int telephony_network_get_mcc(telephony_h handle, char **mcc)
 int telephony_network_get_mnc(telephony_h handle, char **mnc)
 {
 	int ret;
-	char *plmn_str = NULL;
-	int plmn_length;
+	char plmn_mcc[TELEPHONY_NETWORK_MCC_LEN_MAX + 1];
+	char plmn_mnc[TELEPHONY_NETWORK_MNC_LEN_MAX + 1];
 	TapiHandle *tapi_h;
 
 	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
@@ -190,20 +589,13 @@ int telephony_network_get_mnc(telephony_h handle, char **mnc)
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(mnc);
 
-	ret = tel_get_property_string(tapi_h, TAPI_PROP_NETWORK_PLMN, &plmn_str);
+	ret = _get_network_plmn((telephony_data *)handle, plmn_mcc, plmn_mnc);
 	if (ret == TAPI_API_SUCCESS) {
-		plmn_length = strlen(plmn_str);
-		LOGI("plmn:[%s], length:[%d]", plmn_str, plmn_length);
-
-		*mnc = malloc(sizeof(char) * (plmn_length -3 + 1));
+		*mnc = strdup(plmn_mnc);
 		if (*mnc == NULL) {
 			LOGE("OUT_OF_MEMORY");
 			ret = TELEPHONY_ERROR_OUT_OF_MEMORY;
 		} else {
-			memset(*mnc, 0x00, (plmn_length -3 + 1));
-			strncpy(*mnc, plmn_str + 3, (plmn_length -3 + 1));
-			free(plmn_str);
-
 			LOGI("mnc:[%s]", *mnc);
 			ret = TELEPHONY_ERROR_NONE;
 		}
@@ -218,6 +610,34 @@ int telephony_network_get_mnc(telephony_h handle, char **mnc)
 	return ret;
 }
 
+int telephony_network_get_plmn(telephony_h handle,
+	char mcc[TELEPHONY_NETWORK_MCC_LEN_MAX + 1], char mnc[TELEPHONY_NETWORK_MNC_LEN_MAX + 1])
+{
+	int ret;
+	TapiHandle *tapi_h;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+	tapi_h = ((telephony_data *)handle)->tapi_h;
+	CHECK_INPUT_PARAMETER(tapi_h);
+	CHECK_INPUT_PARAMETER(mcc);
+	CHECK_INPUT_PARAMETER(mnc);
+
+	ret = _get_network_plmn((telephony_data *)handle, mcc, mnc);
+	if (ret == TAPI_API_SUCCESS) {
+		LOGI("mcc:[%s], mnc:[%s]", mcc, mnc);
+		ret = TELEPHONY_ERROR_NONE;
+	} else if (ret == TAPI_API_ACCESS_DENIED) {
+		LOGE("PERMISSION_DENIED");
+		ret = TELEPHONY_ERROR_PERMISSION_DENIED;
+	} else {
+		LOGE("OPERATION_FAILED");
+		ret = TELEPHONY_ERROR_OPERATION_FAILED;
+	}
+
+	return ret;
+}
+
 int telephony_network_get_network_name(telephony_h handle, char **network_name)
 {
 	int ret;
@@ -229,7 +649,7 @@ int telephony_network_get_network_name(telephony_h handle, char **network_name)
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(network_name);
 
-	ret = tel_get_property_string(tapi_h, TAPI_PROP_NETWORK_NETWORK_NAME, network_name);
+	ret = _get_network_property_string((telephony_data *)handle, NETWORK_PROP_NETWORK_NAME, network_name);
 	if (ret == TAPI_API_SUCCESS) {
 		LOGI("network_name:[%s]", *network_name);
 		ret = TELEPHONY_ERROR_NONE;
@@ -256,23 +676,9 @@ int telephony_network_get_network_name_option(telephony_h handle, telephony_netw
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(network_name_option);
 
-	ret = tel_get_property_int(tapi_h, TAPI_PROP_NETWORK_NAME_OPTION, &name_option);
+	ret = _get_network_property_int((telephony_data *)handle, NETWORK_PROP_NAME_OPTION, &name_option);
 	if (ret == TAPI_API_SUCCESS) {
-		switch (name_option) {
-		case TAPI_NETWORK_NAME_OPTION_SPN:
-			*network_name_option = TELEPHONY_NETWORK_NAME_OPTION_SPN;
-			break;
-		case TAPI_NETWORK_NAME_OPTION_OPERATOR:
-			*network_name_option = TELEPHONY_NETWORK_NAME_OPTION_NETWORK;
-			break;
-		case TAPI_NETWORK_NAME_OPTION_ANY:
-			*network_name_option = TELEPHONY_NETWORK_NAME_OPTION_ANY;
-			break;
-		default:
-			*network_name_option = TELEPHONY_NETWORK_NAME_OPTION_UNKNOWN;
-			break;
-		}
-
+		*network_name_option = _mapping_name_option(name_option);
 		LOGI("network_name_option:[%d]", *network_name_option);
 		ret = TELEPHONY_ERROR_NONE;
 	} else if (ret == TAPI_API_ACCESS_DENIED) {
@@ -298,32 +704,9 @@ int telephony_network_get_type(telephony_h handle, telephony_network_type_e *net
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(network_type);
 
-	ret = tel_get_property_int(tapi_h, TAPI_PROP_NETWORK_SERVICE_TYPE, &service_type);
+	ret = _get_network_property_int((telephony_data *)handle, NETWORK_PROP_SERVICE_TYPE, &service_type);
 	if (ret == TAPI_API_SUCCESS) {
-		switch (service_type) {
-		case TAPI_NETWORK_SERVICE_TYPE_2G:
-			*network_type = TELEPHONY_NETWORK_TYPE_GSM;
-			break;
-		case TAPI_NETWORK_SERVICE_TYPE_2_5G:
-			*network_type = TELEPHONY_NETWORK_TYPE_GPRS;
-			break;
-		case TAPI_NETWORK_SERVICE_TYPE_2_5G_EDGE:
-			*network_type = TELEPHONY_NETWORK_TYPE_EDGE;
-			break;
-		case TAPI_NETWORK_SERVICE_TYPE_3G:
-			*network_type = TELEPHONY_NETWORK_TYPE_UMTS;
-			break;
-		case TAPI_NETWORK_SERVICE_TYPE_HSDPA:
-			*network_type = TELEPHONY_NETWORK_TYPE_HSDPA;
-			break;
-		case TAPI_NETWORK_SERVICE_TYPE_LTE:
-			*network_type = TELEPHONY_NETWORK_TYPE_LTE;
-			break;
-		default:
-			*network_type = TELEPHONY_NETWORK_TYPE_UNKNOWN;
-			break;
-		}
-
+		*network_type = _mapping_network_type(service_type);
 		LOGI("network_type:[%d]", *network_type);
 		ret = TELEPHONY_ERROR_NONE;
 	} else if (ret == TAPI_API_ACCESS_DENIED) {
@@ -349,26 +732,9 @@ int telephony_network_get_ps_type(telephony_h handle, telephony_network_ps_type_
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(ps_type);
 
-	ret = tel_get_property_int(tapi_h, TAPI_PROP_NETWORK_PS_TYPE, &service_type);
+	ret = _get_network_property_int((telephony_data *)handle, NETWORK_PROP_PS_TYPE, &service_type);
 	if (ret == TAPI_API_SUCCESS) {
-		switch (service_type) {
-		case TAPI_NETWORK_PS_TYPE_HSDPA:
-			*ps_type = TELEPHONY_NETWORK_PS_TYPE_HSDPA;
-			break;
-		case TAPI_NETWORK_PS_TYPE_HSUPA:
-			*ps_type = TELEPHONY_NETWORK_PS_TYPE_HSUPA;
-			break;
-		case TAPI_NETWORK_PS_TYPE_HSPA:
-			*ps_type = TELEPHONY_NETWORK_PS_TYPE_HSPA;
-			break;
-		case TAPI_NETWORK_PS_TYPE_HSPAP:
-			*ps_type = TELEPHONY_NETWORK_PS_TYPE_HSPAP;
-			break;
-		default:
-			*ps_type = TELEPHONY_NETWORK_PS_TYPE_UNKNOWN;
-			break;
-		}
-
+		*ps_type = _mapping_ps_type(service_type);
 		LOGI("ps_type:[%d]", *ps_type);
 		ret = TELEPHONY_ERROR_NONE;
 	} else if (ret == TAPI_API_ACCESS_DENIED) {
@@ -394,21 +760,9 @@ int telephony_network_get_service_state(telephony_h handle, telephony_network_se
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(network_service_state);
 
-	ret = tel_get_property_int(tapi_h, TAPI_PROP_NETWORK_SERVICE_TYPE, &service_type);
+	ret = _get_network_property_int((telephony_data *)handle, NETWORK_PROP_SERVICE_TYPE, &service_type);
 	if (ret == TAPI_API_SUCCESS) {
-		switch (service_type) {
-		case TAPI_NETWORK_SERVICE_TYPE_UNKNOWN:
-		case TAPI_NETWORK_SERVICE_TYPE_NO_SERVICE:
-		case TAPI_NETWORK_SERVICE_TYPE_SEARCH:
-			*network_service_state = TELEPHONY_NETWORK_SERVICE_STATE_OUT_OF_SERVICE;
-			break;
-		case TAPI_NETWORK_SERVICE_TYPE_EMERGENCY:
-			*network_service_state = TELEPHONY_NETWORK_SERVICE_STATE_EMERGENCY_ONLY;
-			break;
-		default:
-			*network_service_state = TELEPHONY_NETWORK_SERVICE_STATE_IN_SERVICE;
-			break;
-		}
+		*network_service_state = _mapping_service_state(service_type);
 		LOGI("network_service_state:[%d]", *network_service_state);
 		ret = TELEPHONY_ERROR_NONE;
 	} else if (ret == TAPI_API_ACCESS_DENIED) {
@@ -502,3 +856,316 @@ int telephony_network_get_default_subscription(telephony_h handle,
 	return ret;
 }
 
+int telephony_network_get_snapshot(telephony_h handle, telephony_network_snapshot_s *snapshot)
+{
+	GVariant *gv = NULL;
+	GError *gerr = NULL;
+	GVariantIter *iter = NULL;
+	const gchar *key = NULL;
+	GVariant *value = NULL;
+	telephony_network_props fetched;
+	telephony_network_cache *cache;
+	guint generation;
+	int prop;
+	TapiHandle *tapi_h;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+	tapi_h = ((telephony_data *)handle)->tapi_h;
+	CHECK_INPUT_PARAMETER(tapi_h);
+	CHECK_INPUT_PARAMETER(snapshot);
+	cache = &((telephony_data *)handle)->network_cache;
+
+	g_mutex_lock(&cache->mutex);
+	generation = cache->generation;
+	g_mutex_unlock(&cache->mutex);
+
+	/* All network properties in one round trip, so they are consistent with each other */
+	gv = g_dbus_connection_call_sync(tapi_h->dbus_connection,
+		DBUS_TELEPHONY_SERVICE, tapi_h->path, DBUS_PROPERTIES_INTERFACE,
+		"GetAll", g_variant_new("(s)", DBUS_TELEPHONY_NETWORK_INTERFACE),
+		G_VARIANT_TYPE("(a{sv})"), G_DBUS_CALL_FLAGS_NONE, -1, NULL, &gerr);
+	if (gv == NULL) {
+		LOGE("g_dbus_conn failed. error (%s)", gerr->message);
+		if (strstr(gerr->message, "No access rights")) {
+			LOGE("PERMISSION_DENIED");
+			g_error_free(gerr);
+			return TELEPHONY_ERROR_PERMISSION_DENIED;
+		}
+		g_error_free(gerr);
+		return TELEPHONY_ERROR_OPERATION_FAILED;
+	}
+
+	memset(&fetched, 0x00, sizeof(telephony_network_props));
+	g_variant_get(gv, "(a{sv})", &iter);
+	while (g_variant_iter_loop(iter, "{&sv}", &key, &value)) {
+		prop = _find_network_prop(DBUS_TELEPHONY_NETWORK_INTERFACE, key);
+		if (prop >= 0)
+			_network_props_store(&fetched, prop, value);
+	}
+	g_variant_iter_free(iter);
+	g_variant_unref(gv);
+
+	/* Refresh the cache as well, unless a newer value has arrived meanwhile */
+	g_mutex_lock(&cache->mutex);
+	if (cache->prop_changed_id && cache->generation == generation) {
+		for (prop = 0; prop < NETWORK_PROP_MAX; prop++) {
+			if (!(fetched.valid & NETWORK_PROP_BIT(prop)))
+				continue;
+			if (_is_string_network_prop(prop))
+				_network_cache_set_string(cache, prop, fetched.str_value[prop]);
+			else
+				cache->int_value[prop] = fetched.int_value[prop];
+			_network_history_update(cache, prop);
+		}
+		cache->valid |= fetched.valid;
+		cache->generation++;
+	}
+	g_mutex_unlock(&cache->mutex);
+
+	/* Properties missing from the reply are reported as zero or unknown */
+	memset(snapshot, 0x00, sizeof(telephony_network_snapshot_s));
+	snapshot->lac = fetched.int_value[NETWORK_PROP_LAC];
+	snapshot->cell_id = fetched.int_value[NETWORK_PROP_CELLID];
+	snapshot->rssi = fetched.int_value[NETWORK_PROP_SIGNALSTRENGTH_LEVEL];
+	snapshot->roaming_status = fetched.int_value[NETWORK_PROP_ROAMING_STATUS] == 1;
+	_parse_plmn(fetched.str_value[NETWORK_PROP_PLMN], snapshot->mcc, snapshot->mnc);
+	if (fetched.str_value[NETWORK_PROP_NETWORK_NAME])
+		g_strlcpy(snapshot->network_name, fetched.str_value[NETWORK_PROP_NETWORK_NAME],
+			sizeof(snapshot->network_name));
+	snapshot->network_name_option = _mapping_name_option(fetched.int_value[NETWORK_PROP_NAME_OPTION]);
+	snapshot->network_type = _mapping_network_type(fetched.int_value[NETWORK_PROP_SERVICE_TYPE]);
+	snapshot->ps_type = _mapping_ps_type(fetched.int_value[NETWORK_PROP_PS_TYPE]);
+	if (fetched.valid & NETWORK_PROP_BIT(NETWORK_PROP_SERVICE_TYPE))
+		snapshot->service_state = _mapping_service_state(fetched.int_value[NETWORK_PROP_SERVICE_TYPE]);
+	else
+		snapshot->service_state = TELEPHONY_NETWORK_SERVICE_STATE_OUT_OF_SERVICE;
+
+	for (prop = 0; prop < NETWORK_PROP_MAX; prop++)
+		g_free(fetched.str_value[prop]);
+
+	LOGI("lac:[%d] cell_id:[%d] rssi:[%d] roaming:[%d] mcc:[%s] mnc:[%s] name:[%s] service_state:[%d]",
+		snapshot->lac, snapshot->cell_id, snapshot->rssi, snapshot->roaming_status,
+		snapshot->mcc, snapshot->mnc, snapshot->network_name, snapshot->service_state);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+int telephony_network_get_cache_stats(telephony_h handle,
+	unsigned int *hit_count, unsigned int *miss_count)
+{
+	telephony_network_cache *cache;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+	CHECK_INPUT_PARAMETER(hit_count);
+	CHECK_INPUT_PARAMETER(miss_count);
+	cache = &((telephony_data *)handle)->network_cache;
+
+	g_mutex_lock(&cache->mutex);
+	*hit_count = cache->hit_count;
+	*miss_count = cache->miss_count;
+	g_mutex_unlock(&cache->mutex);
+
+	LOGI("hit_count:[%u], miss_count:[%u]", *hit_count, *miss_count);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+int telephony_network_history_enable(telephony_h handle, unsigned int capacity)
+{
+	telephony_network_cache *cache;
+	telephony_network_history *history;
+	int prop;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+	cache = &((telephony_data *)handle)->network_cache;
+
+	if (capacity == 0 || capacity > TELEPHONY_NETWORK_HISTORY_CAPACITY_MAX) {
+		LOGE("INVALID_PARAMETER");
+		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	}
+
+	g_mutex_lock(&cache->mutex);
+	history = &cache->history;
+	g_free(history->deltas);
+	history->deltas = g_new(telephony_network_history_delta, capacity);
+	history->capacity = capacity;
+	history->head = 0;
+	history->count = 0;
+	history->base_timestamp = g_get_monotonic_time();
+
+	/* The history starts from the cached values */
+	memset(&history->base, 0x00, sizeof(history->base));
+	history->base.valid = cache->valid & NETWORK_HISTORY_PROPS;
+	for (prop = 0; prop < NETWORK_PROP_MAX; prop++)
+		history->base.int_value[prop] = cache->int_value[prop];
+	if (cache->str_value[NETWORK_PROP_PLMN])
+		g_strlcpy(history->base.plmn, cache->str_value[NETWORK_PROP_PLMN], sizeof(history->base.plmn));
+	history->current = history->base;
+	g_mutex_unlock(&cache->mutex);
+
+	LOGI("Network history enabled, capacity: [%u]", capacity);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+int telephony_network_history_disable(telephony_h handle)
+{
+	telephony_network_cache *cache;
+	telephony_network_history_delta *deltas;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+	cache = &((telephony_data *)handle)->network_cache;
+
+	g_mutex_lock(&cache->mutex);
+	deltas = cache->history.deltas;
+	/* Nothing of this history may show through a later one */
+	memset(&cache->history, 0x00, sizeof(cache->history));
+	g_mutex_unlock(&cache->mutex);
+
+	g_free(deltas);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+/* Number of deltas older than timestamp, or not newer when inclusive */
+static guint _network_history_bound(const telephony_network_history *history,
+	unsigned long long timestamp, gboolean inclusive)
+{
+	guint low = 0, high = history->count;
+
+	/* Compared as the API takes them, a monotonic time is never negative */
+	while (low < high) {
+		guint mid = low + (high - low) / 2;
+		unsigned long long mid_timestamp = _network_history_get(history, mid)->timestamp;
+
+		if (mid_timestamp < timestamp || (inclusive && mid_timestamp == timestamp))
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+/* State once the first count deltas are applied */
+static void _network_history_state_at(const telephony_network_history *history, guint count,
+	telephony_network_history_state *state)
+{
+	guint found = 0;
+	guint i;
+
+	/* Only the latest change of each property matters, walk back from it */
+	memset(state, 0x00, sizeof(*state));
+	for (i = count; i > 0 && found != NETWORK_HISTORY_PROPS; i--) {
+		const telephony_network_history_delta *delta = _network_history_get(history, i - 1);
+
+		if (found & NETWORK_PROP_BIT(delta->prop))
+			continue;
+		found |= NETWORK_PROP_BIT(delta->prop);
+		_network_history_apply(state, delta);
+	}
+
+	for (i = 0; i < NETWORK_PROP_MAX; i++) {
+		if (found & NETWORK_PROP_BIT(i) || !(history->base.valid & NETWORK_PROP_BIT(i)))
+			continue;
+		state->int_value[i] = history->base.int_value[i];
+		state->valid |= NETWORK_PROP_BIT(i);
+	}
+	if (!(found & NETWORK_PROP_BIT(NETWORK_PROP_PLMN)))
+		g_strlcpy(state->plmn, history->base.plmn, sizeof(state->plmn));
+}
+
+static void _network_history_fill_snapshot(const telephony_network_history_state *state,
+	telephony_network_snapshot_s *snapshot)
+{
+	/* Properties the history does not record, or did not know yet, are zero or unknown */
+	memset(snapshot, 0x00, sizeof(telephony_network_snapshot_s));
+	snapshot->lac = state->int_value[NETWORK_PROP_LAC];
+	snapshot->cell_id = state->int_value[NETWORK_PROP_CELLID];
+	snapshot->rssi = state->int_value[NETWORK_PROP_SIGNALSTRENGTH_LEVEL];
+	_parse_plmn(state->plmn, snapshot->mcc, snapshot->mnc);
+	snapshot->network_type = _mapping_network_type(state->int_value[NETWORK_PROP_SERVICE_TYPE]);
+	snapshot->ps_type = _mapping_ps_type(state->int_value[NETWORK_PROP_PS_TYPE]);
+	if (state->valid & NETWORK_PROP_BIT(NETWORK_PROP_SERVICE_TYPE))
+		snapshot->service_state = _mapping_service_state(state->int_value[NETWORK_PROP_SERVICE_TYPE]);
+	else
+		snapshot->service_state = TELEPHONY_NETWORK_SERVICE_STATE_OUT_OF_SERVICE;
+}
+
+int telephony_network_history_at(telephony_h handle, unsigned long long timestamp,
+	telephony_network_snapshot_s *snapshot)
+{
+	telephony_network_cache *cache;
+	telephony_network_history *history;
+	telephony_network_history_state state;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+	CHECK_INPUT_PARAMETER(snapshot);
+	cache = &((telephony_data *)handle)->network_cache;
+	history = &cache->history;
+
+	g_mutex_lock(&cache->mutex);
+	if (history->deltas == NULL || timestamp < (unsigned long long)history->base_timestamp) {
+		g_mutex_unlock(&cache->mutex);
+		LOGE("No history at [%llu]", timestamp);
+		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	}
+	_network_history_state_at(history, _network_history_bound(history, timestamp, TRUE), &state);
+	g_mutex_unlock(&cache->mutex);
+
+	_network_history_fill_snapshot(&state, snapshot);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+int telephony_network_history_foreach(telephony_h handle, unsigned long long from,
+	unsigned long long to, telephony_network_history_cb callback, void *user_data)
+{
+	telephony_network_cache *cache;
+	telephony_network_history *history;
+	telephony_network_history_state state;
+	telephony_network_history_delta *deltas;
+	telephony_network_snapshot_s snapshot;
+	guint first, last, i;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+	CHECK_INPUT_PARAMETER(callback);
+	cache = &((telephony_data *)handle)->network_cache;
+	history = &cache->history;
+
+	if (from > to) {
+		LOGE("INVALID_PARAMETER");
+		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	}
+
+	/* The changes are copied so that the callback runs without the lock held */
+	g_mutex_lock(&cache->mutex);
+	if (history->deltas == NULL) {
+		g_mutex_unlock(&cache->mutex);
+		LOGE("History is not enabled");
+		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	}
+	first = _network_history_bound(history, from, FALSE);
+	last = _network_history_bound(history, to, TRUE);
+	_network_history_state_at(history, first, &state);
+	deltas = g_new(telephony_network_history_delta, last - first + 1);
+	for (i = first; i < last; i++)
+		deltas[i - first] = *_network_history_get(history, i);
+	g_mutex_unlock(&cache->mutex);
+
+	for (i = 0; i < last - first; i++) {
+		_network_history_apply(&state, &deltas[i]);
+		_network_history_fill_snapshot(&state, &snapshot);
+		if (!callback(deltas[i].timestamp, &snapshot, user_data))
+			break;
+	}
+	g_free(deltas);
+
+	return TELEPHONY_ERROR_NONE;
+}
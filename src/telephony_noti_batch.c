@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2014 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <glib.h>
+#include <dlog.h>
+
+#include "telephony_common.h"
+#include "telephony_private.h"
+
+/* Events a batch can hold without growing */
+#define NOTI_BATCH_RESERVED_SIZE 16
+
+/*
+ * Notifications collected for a telephony_noti_batch_cb.
+ * Events are appended by the thread dispatching the notifications of the
+ * handle, which also runs the flush source since it is attached to the
+ * main context of the handle.
+ */
+struct _telephony_noti_batch_s {
+	gint ref_count; /* Held by the application, by each subscription and by the flush source */
+	telephony_data *handle_data;
+	GMainContext *context; /* Of the handle, where the flush source is attached */
+	telephony_noti_batch_cb cb;
+	void *user_data;
+	guint window_ms; /* 0 to flush once the main loop is idle */
+	GMutex mutex; /* Protects the members below */
+	GArray *events; /* Array of telephony_event_s, in reception order */
+	GSource *flush_source; /* Pending flush, NULL if events is empty */
+	gboolean removed;
+};
+
+telephony_noti_batch_h _telephony_noti_batch_ref(telephony_noti_batch_h batch)
+{
+	g_atomic_int_inc(&batch->ref_count);
+	return batch;
+}
+
+void _telephony_noti_batch_unref(telephony_noti_batch_h batch)
+{
+	if (!g_atomic_int_dec_and_test(&batch->ref_count))
+		return;
+
+	g_array_free(batch->events, TRUE);
+	g_mutex_clear(&batch->mutex);
+	g_main_context_unref(batch->context);
+	g_free(batch);
+}
+
+static gboolean _noti_batch_flush(gpointer user_data)
+{
+	telephony_noti_batch_h batch = user_data;
+	GArray *events;
+	gboolean removed;
+
+	/* Callbacks are called without the lock held, they may unset the batch */
+	g_mutex_lock(&batch->mutex);
+	events = batch->events;
+	batch->events = g_array_sized_new(FALSE, FALSE, sizeof(telephony_event_s), NOTI_BATCH_RESERVED_SIZE);
+	if (batch->flush_source) {
+		g_source_unref(batch->flush_source);
+		batch->flush_source = NULL;
+	}
+	removed = batch->removed;
+	g_mutex_unlock(&batch->mutex);
+
+	if (!removed && events->len > 0)
+		batch->cb((telephony_h)batch->handle_data,
+			(const telephony_event_s *)events->data, events->len, batch->user_data);
+	g_array_free(events, TRUE);
+
+	return FALSE;
+}
+
+void _telephony_noti_batch_append(telephony_noti_batch_h batch, const telephony_event_s *event)
+{
+	g_mutex_lock(&batch->mutex);
+	if (batch->removed) {
+		g_mutex_unlock(&batch->mutex);
+		return;
+	}
+
+	g_array_append_vals(batch->events, event, 1);
+	if (batch->flush_source == NULL) {
+		/* The first event of a batch decides when it is delivered */
+		if (batch->window_ms)
+			batch->flush_source = g_timeout_source_new(batch->window_ms);
+		else
+			batch->flush_source = g_idle_source_new();
+		g_source_set_callback(batch->flush_source, _noti_batch_flush,
+			_telephony_noti_batch_ref(batch), (GDestroyNotify)_telephony_noti_batch_unref);
+		g_source_attach(batch->flush_source, batch->context);
+	}
+	g_mutex_unlock(&batch->mutex);
+}
+
+int telephony_set_noti_batch_cb(telephony_h handle, const telephony_noti_e *noti_ids,
+	unsigned int count, unsigned int window_ms, telephony_noti_batch_cb cb, void *user_data,
+	telephony_noti_batch_h *batch)
+{
+	telephony_noti_batch_h tmp;
+	telephony_noti_sink sink = { NULL, NULL };
+	int ret;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+	CHECK_INPUT_PARAMETER(noti_ids);
+	CHECK_INPUT_PARAMETER(cb);
+	CHECK_INPUT_PARAMETER(batch);
+
+	if (count == 0) {
+		LOGE("INVALID_PARAMETER");
+		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	}
+
+	tmp = g_new0(struct _telephony_noti_batch_s, 1);
+	tmp->ref_count = 1;
+	tmp->handle_data = (telephony_data *)handle;
+	tmp->context = g_main_context_ref(tmp->handle_data->context);
+	tmp->cb = cb;
+	tmp->user_data = user_data;
+	tmp->window_ms = window_ms;
+	g_mutex_init(&tmp->mutex);
+	tmp->events = g_array_sized_new(FALSE, FALSE, sizeof(telephony_event_s), NOTI_BATCH_RESERVED_SIZE);
+
+	sink.batch = tmp;
+	ret = _telephony_noti_subscribe_sink(tmp->handle_data, noti_ids, count, &sink);
+	if (ret != TELEPHONY_ERROR_NONE) {
+		_telephony_noti_batch_unref(tmp);
+		return ret;
+	}
+
+	*batch = tmp;
+	LOGI("Batch callback set, window: [%u] ms", window_ms);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+int telephony_unset_noti_batch_cb(telephony_noti_batch_h batch)
+{
+	telephony_noti_sink sink = { NULL, NULL };
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(batch);
+
+	sink.batch = batch;
+	_telephony_noti_unsubscribe_sink(batch->handle_data, &sink);
+
+	/* A flush which is already pending does not call back anymore */
+	g_mutex_lock(&batch->mutex);
+	batch->removed = TRUE;
+	if (batch->flush_source) {
+		g_source_destroy(batch->flush_source);
+		g_source_unref(batch->flush_source);
+		batch->flush_source = NULL;
+	}
+	g_mutex_unlock(&batch->mutex);
+
+	_telephony_noti_batch_unref(batch);
+
+	return TELEPHONY_ERROR_NONE;
+}
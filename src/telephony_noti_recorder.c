@@ -0,0 +1,484 @@
+/*
+ * Copyright (c) 2014 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <glib.h>
+#include <dlog.h>
+
+#include "telephony_common.h"
+#include "telephony_private.h"
+
+#define NOTI_RECORD_MAGIC 0x524e4554 /* "TENR" */
+#define NOTI_RECORD_VERSION 1
+
+/*
+ * Start of a recording file, followed by a ring of records.
+ * Offsets are relative to the ring, every field is in host byte order.
+ */
+typedef struct {
+	guint32 magic;
+	guint32 version;
+	guint32 size; /* Of the ring in bytes */
+	guint32 head; /* Oldest record */
+	guint32 tail; /* Where the next record is written */
+	guint32 count; /* Records in the ring */
+} telephony_noti_record_file_header;
+
+/*
+ * Start of a record, followed by the event name and the string payload,
+ * both without terminating null byte. A length of 0, or less room than a
+ * record header before the end of the ring, means the next record is at
+ * the start of the ring.
+ */
+typedef struct {
+	guint16 length; /* Of the whole record */
+	guint8 handle_index;
+	guint8 type;
+	guint8 evt_id_len;
+	guint8 string_len;
+	guint16 reserved;
+	gint32 value;
+	gint32 call_state;
+	gint64 timestamp;
+} telephony_noti_record_header;
+
+/* A mapped recording file */
+typedef struct {
+	int fd;
+	void *map;
+	gsize map_size;
+	telephony_noti_record_file_header *header;
+	guint8 *ring;
+} telephony_noti_record_file;
+
+static GMutex recorder_mutex;
+static telephony_noti_record_file *recorder; /* Protected by recorder_mutex */
+static gint recorder_active;
+
+static guint16 _record_length_at(const telephony_noti_record_file *file, guint32 offset)
+{
+	guint16 length;
+
+	if (file->header->size - offset < sizeof(telephony_noti_record_header))
+		return 0;
+	memcpy(&length, file->ring + offset, sizeof(length));
+
+	return length;
+}
+
+/* Offset of the record at offset, or of the next one if the ring wraps there */
+static guint32 _record_offset(const telephony_noti_record_file *file, guint32 offset)
+{
+	return _record_length_at(file, offset) ? offset : 0;
+}
+
+/* head always points to a record, it wraps as soon as it reaches the end of the ring */
+static void _record_evict_oldest(telephony_noti_record_file *file)
+{
+	telephony_noti_record_file_header *header = file->header;
+
+	header->head += _record_length_at(file, header->head);
+	header->head = _record_offset(file, header->head);
+	header->count--;
+}
+
+static void _record_write(telephony_noti_record_file *file, const telephony_noti_record *record)
+{
+	telephony_noti_record_file_header *header = file->header;
+	telephony_noti_record_header rec;
+	gsize evt_id_len = MIN(strlen(record->evt_id), G_MAXUINT8);
+	gsize string_len = record->string ? MIN(strlen(record->string), G_MAXUINT8) : 0;
+	guint32 length = sizeof(rec) + evt_id_len + string_len;
+	guint32 offset = header->tail;
+
+	if (header->size - offset < length) {
+		/* Records from here to the end of the ring are the oldest ones */
+		while (header->count > 0 && header->head >= offset)
+			_record_evict_oldest(file);
+		if (header->size - offset >= sizeof(rec.length))
+			memset(file->ring + offset, 0, sizeof(rec.length));
+		offset = 0;
+	}
+	while (header->count > 0 && header->head >= offset && header->head < offset + length)
+		_record_evict_oldest(file);
+	if (header->count == 0)
+		header->head = offset;
+
+	rec.length = length;
+	rec.handle_index = MIN(record->handle_index, G_MAXUINT8);
+	rec.type = record->type;
+	rec.evt_id_len = evt_id_len;
+	rec.string_len = string_len;
+	rec.reserved = 0;
+	rec.value = record->value;
+	rec.call_state = record->call_state;
+	rec.timestamp = record->timestamp;
+	memcpy(file->ring + offset, &rec, sizeof(rec));
+	memcpy(file->ring + offset + sizeof(rec), record->evt_id, evt_id_len);
+	if (string_len)
+		memcpy(file->ring + offset + sizeof(rec) + evt_id_len, record->string, string_len);
+
+	/* The header is updated last, so that it only points to complete records */
+	header->tail = offset + length;
+	header->count++;
+}
+
+static void _record_file_close(telephony_noti_record_file *file)
+{
+	munmap(file->map, file->map_size);
+	close(file->fd);
+	g_free(file);
+}
+
+/* Maps path, which must hold a valid recording when create is FALSE */
+static telephony_noti_record_file *_record_file_open(const char *path, guint32 size, gboolean create)
+{
+	telephony_noti_record_file *file = g_new0(telephony_noti_record_file, 1);
+	telephony_noti_record_file_header *header;
+	struct stat st;
+
+	file->fd = open(path, create ? O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC : O_RDONLY | O_CLOEXEC, 0600);
+	if (file->fd < 0) {
+		LOGE("Cannot open [%s]", path);
+		g_free(file);
+		return NULL;
+	}
+
+	if (create) {
+		file->map_size = sizeof(*header) + size;
+		if (ftruncate(file->fd, file->map_size) < 0) {
+			LOGE("Cannot resize [%s]", path);
+			close(file->fd);
+			g_free(file);
+			return NULL;
+		}
+	} else {
+		if (fstat(file->fd, &st) < 0 || (gsize)st.st_size < sizeof(*header)) {
+			LOGE("Invalid recording [%s]", path);
+			close(file->fd);
+			g_free(file);
+			return NULL;
+		}
+		file->map_size = st.st_size;
+	}
+
+	file->map = mmap(NULL, file->map_size, create ? PROT_READ | PROT_WRITE : PROT_READ,
+		MAP_SHARED, file->fd, 0);
+	if (file->map == MAP_FAILED) {
+		LOGE("Cannot map [%s]", path);
+		close(file->fd);
+		g_free(file);
+		return NULL;
+	}
+	file->header = header = file->map;
+	file->ring = (guint8 *)file->map + sizeof(*header);
+
+	if (create) {
+		header->magic = NOTI_RECORD_MAGIC;
+		header->version = NOTI_RECORD_VERSION;
+		header->size = size;
+		header->head = 0;
+		header->tail = 0;
+		header->count = 0;
+	} else if (header->magic != NOTI_RECORD_MAGIC || header->version != NOTI_RECORD_VERSION
+			|| header->size != file->map_size - sizeof(*header)
+			|| header->head > header->size || header->tail > header->size
+			|| header->count > header->size / sizeof(telephony_noti_record_header)) {
+		LOGE("Invalid recording [%s]", path);
+		_record_file_close(file);
+		return NULL;
+	}
+
+	return file;
+}
+
+gboolean _telephony_noti_recorder_is_active(void)
+{
+	return g_atomic_int_get(&recorder_active);
+}
+
+void _telephony_noti_recorder_append(const telephony_noti_record *record)
+{
+	g_mutex_lock(&recorder_mutex);
+	if (recorder)
+		_record_write(recorder, record);
+	g_mutex_unlock(&recorder_mutex);
+}
+
+int telephony_noti_recorder_start(const char *path, unsigned int size)
+{
+	telephony_noti_record_file *file;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(path);
+
+	if (size < TELEPHONY_NOTI_RECORDER_SIZE_MIN || size > TELEPHONY_NOTI_RECORDER_SIZE_MAX) {
+		LOGE("INVALID_PARAMETER");
+		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	}
+
+	g_mutex_lock(&recorder_mutex);
+	if (recorder) {
+		g_mutex_unlock(&recorder_mutex);
+		LOGE("Recorder already started");
+		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	}
+	file = _record_file_open(path, size, TRUE);
+	if (file == NULL) {
+		g_mutex_unlock(&recorder_mutex);
+		return TELEPHONY_ERROR_OPERATION_FAILED;
+	}
+	recorder = file;
+	g_atomic_int_set(&recorder_active, TRUE);
+	g_mutex_unlock(&recorder_mutex);
+
+	LOGI("Recording notifications to [%s], size: [%u]", path, size);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+int telephony_noti_recorder_stop(void)
+{
+	telephony_noti_record_file *file;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+
+	g_mutex_lock(&recorder_mutex);
+	file = recorder;
+	recorder = NULL;
+	g_atomic_int_set(&recorder_active, FALSE);
+	g_mutex_unlock(&recorder_mutex);
+
+	if (file == NULL) {
+		LOGE("Recorder not started");
+		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	}
+
+	LOGI("Recorder stopped, records: [%u]", file->header->count);
+	msync(file->map, file->map_size, MS_SYNC);
+	_record_file_close(file);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+/* A recorded event waiting to be replayed */
+typedef struct {
+	gint64 delay; /* From the start of the replay, in microseconds */
+	guint handle_index;
+	char *evt_id;
+	gint type;
+	gint value;
+	gint call_state;
+	char *string;
+} telephony_noti_replay_entry;
+
+/* A replay in progress, each entry is queued by its own source */
+typedef struct {
+	telephony_data **handles; /* Of the replayed handle list */
+	guint handle_count;
+	GArray *entries; /* telephony_noti_replay_entry, in recorded order */
+	guint next; /* Entry queued by source */
+	gint64 start; /* Monotonic time the replay started */
+	GSource *source;
+} telephony_noti_replay_state;
+
+static GMutex replay_mutex;
+static telephony_noti_replay_state *noti_replay; /* Protected by replay_mutex */
+
+static void _replay_free(telephony_noti_replay_state *replay)
+{
+	telephony_noti_replay_entry *entry;
+	guint i;
+
+	for (i = 0; i < replay->entries->len; i++) {
+		entry = &g_array_index(replay->entries, telephony_noti_replay_entry, i);
+		g_free(entry->evt_id);
+		g_free(entry->string);
+	}
+	g_array_free(replay->entries, TRUE);
+	g_free(replay->handles);
+	g_free(replay);
+}
+
+/* Copies the records of file, the recorder may overwrite it while they are replayed */
+static telephony_noti_replay_state *_replay_load(const telephony_noti_record_file *file,
+	telephony_handle_list_s *list, gboolean realtime)
+{
+	telephony_noti_replay_state *replay;
+	telephony_noti_replay_entry entry;
+	telephony_noti_record_header rec;
+	gint64 first_recorded = 0;
+	guint32 offset = file->header->head;
+	guint32 i;
+
+	replay = g_new0(telephony_noti_replay_state, 1);
+	replay->handles = g_new(telephony_data *, list->count);
+	memcpy(replay->handles, list->handle, list->count * sizeof(telephony_h));
+	replay->handle_count = list->count;
+	replay->entries = g_array_sized_new(FALSE, FALSE, sizeof(entry), file->header->count);
+
+	for (i = 0; i < file->header->count; i++) {
+		offset = _record_offset(file, offset);
+		memcpy(&rec, file->ring + offset, sizeof(rec));
+		if (rec.length < sizeof(rec) + rec.evt_id_len + rec.string_len
+				|| rec.length > file->header->size - offset) {
+			LOGE("Corrupted record at [%u]", offset);
+			_replay_free(replay);
+			return NULL;
+		}
+
+		if (i == 0)
+			first_recorded = rec.timestamp;
+		if (rec.handle_index < list->count) {
+			entry.delay = realtime ? rec.timestamp - first_recorded : 0;
+			entry.handle_index = rec.handle_index;
+			entry.evt_id = g_strndup((const char *)file->ring + offset + sizeof(rec), rec.evt_id_len);
+			entry.type = rec.type;
+			entry.value = rec.value;
+			entry.call_state = rec.call_state;
+			entry.string = g_strndup((const char *)file->ring + offset + sizeof(rec) + rec.evt_id_len,
+				rec.string_len);
+			g_array_append_val(replay->entries, entry);
+		}
+		offset += rec.length;
+	}
+
+	return replay;
+}
+
+static gboolean _on_replay_entry_due(gpointer user_data);
+
+/* Queues the next entry once it is due, replay_mutex must be held */
+static void _replay_schedule(telephony_noti_replay_state *replay)
+{
+	const telephony_noti_replay_entry *entry =
+		&g_array_index(replay->entries, telephony_noti_replay_entry, replay->next);
+	gint64 delay = replay->start + entry->delay - g_get_monotonic_time();
+
+	/* Even when due at once, live notifications get their turn in between */
+	replay->source = g_timeout_source_new(delay > 0 ? (delay + 999) / 1000 : 0);
+	g_source_set_callback(replay->source, _on_replay_entry_due, NULL, NULL);
+	/* On the context of its handle, the next entry is queued only once this one is delivered */
+	g_source_attach(replay->source, replay->handles[entry->handle_index]->context);
+}
+
+/* Stops the replay in progress, replay_mutex must be held */
+static void _replay_stop(void)
+{
+	if (noti_replay == NULL)
+		return;
+
+	if (noti_replay->source) {
+		g_source_destroy(noti_replay->source);
+		g_source_unref(noti_replay->source);
+	}
+	_replay_free(noti_replay);
+	noti_replay = NULL;
+}
+
+static gboolean _on_replay_entry_due(gpointer user_data)
+{
+	telephony_noti_replay_state *replay;
+	const telephony_noti_replay_entry *entry;
+	telephony_noti_record record;
+
+	g_mutex_lock(&replay_mutex);
+	replay = noti_replay;
+	/* Stopped while this source was being dispatched */
+	if (replay == NULL || replay->source != g_main_current_source()) {
+		g_mutex_unlock(&replay_mutex);
+		return FALSE;
+	}
+
+	entry = &g_array_index(replay->entries, telephony_noti_replay_entry, replay->next);
+	record.timestamp = 0;
+	record.handle_index = entry->handle_index;
+	record.evt_id = entry->evt_id;
+	record.type = entry->type;
+	record.value = entry->value;
+	record.call_state = entry->call_state;
+	record.string = entry->string;
+	_telephony_noti_replay_record(replay->handles[entry->handle_index], &record);
+
+	g_source_unref(replay->source);
+	replay->source = NULL;
+	if (++replay->next < replay->entries->len)
+		_replay_schedule(replay);
+	else
+		_replay_stop();
+	g_mutex_unlock(&replay_mutex);
+
+	return FALSE;
+}
+
+void _telephony_noti_replay_cancel(telephony_data *data)
+{
+	guint i;
+
+	g_mutex_lock(&replay_mutex);
+	for (i = 0; noti_replay && i < noti_replay->handle_count; i++) {
+		if (noti_replay->handles[i] == data) {
+			LOGI("Replay stopped at [%u/%u]", noti_replay->next, noti_replay->entries->len);
+			_replay_stop();
+		}
+	}
+	g_mutex_unlock(&replay_mutex);
+}
+
+int telephony_noti_replay(telephony_handle_list_s *list, const char *path, bool realtime,
+	unsigned int *count)
+{
+	telephony_noti_record_file *file;
+	telephony_noti_replay_state *replay;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(list);
+	CHECK_INPUT_PARAMETER(path);
+	CHECK_INPUT_PARAMETER(count);
+
+	if (list->count == 0) {
+		LOGE("INVALID_PARAMETER");
+		return TELEPHONY_ERROR_INVALID_PARAMETER;
+	}
+
+	file = _record_file_open(path, 0, FALSE);
+	if (file == NULL)
+		return TELEPHONY_ERROR_OPERATION_FAILED;
+	replay = _replay_load(file, list, realtime);
+	_record_file_close(file);
+	if (replay == NULL)
+		return TELEPHONY_ERROR_OPERATION_FAILED;
+
+	*count = replay->entries->len;
+	LOGI("Replaying [%u] records of [%s]", *count, path);
+
+	g_mutex_lock(&replay_mutex);
+	_replay_stop();
+	if (replay->entries->len > 0) {
+		noti_replay = replay;
+		replay->start = g_get_monotonic_time();
+		_replay_schedule(replay);
+	} else {
+		_replay_free(replay);
+	}
+	g_mutex_unlock(&replay_mutex);
+
+	return TELEPHONY_ERROR_NONE;
+}
@@ -39,9 +39,8 @@
 #define DBUS_SIM_RESPONSE_DATA_ERROR "SIM RESPONSE DATA ERROR"
 #define DBUS_SIM_ACCESS_DENIED "No access rights"
 
-#define GET_SIM_STATUS(tapi_h, sim_card_state) { \
-	int card_changed = 0; \
-	int ret = tel_get_sim_init_info(tapi_h, &sim_card_state, &card_changed); \
+#define GET_SIM_STATUS(handle, sim_card_state) { \
+	int ret = _get_sim_status((telephony_data *)handle, &sim_card_state); \
 	if (ret == TAPI_API_ACCESS_DENIED) { \
 		LOGE("PERMISSION_DENIED"); \
 		return TELEPHONY_ERROR_PERMISSION_DENIED; \
@@ -51,6 +50,271 @@
 	} \
 }
 
+/* Must be called with cache->mutex held */
+static void _sim_cache_drop_identity(telephony_sim_cache *cache)
+{
+	g_free(cache->icc_id);
+	cache->icc_id = NULL;
+	g_free(cache->spn);
+	cache->spn = NULL;
+	g_free(cache->msisdn);
+	cache->msisdn = NULL;
+	memset(&cache->imsi, 0, sizeof(cache->imsi));
+	cache->app_list = 0;
+	cache->identity_valid = 0;
+}
+
+static char **_sim_cache_identity_string(telephony_sim_cache *cache,
+	telephony_sim_identity_e item)
+{
+	switch (item) {
+	case SIM_IDENTITY_ICC_ID:
+		return &cache->icc_id;
+	case SIM_IDENTITY_SPN:
+		return &cache->spn;
+	case SIM_IDENTITY_MSISDN:
+		return &cache->msisdn;
+	default:
+		return NULL;
+	}
+}
+
+/* Returns the generation to be passed to _sim_identity_store_xxx() */
+static guint _sim_identity_get_generation(telephony_data *data)
+{
+	telephony_sim_cache *cache = &data->sim_cache;
+	guint generation;
+
+	g_mutex_lock(&cache->mutex);
+	generation = cache->generation;
+	g_mutex_unlock(&cache->mutex);
+
+	return generation;
+}
+
+/* Must be called with cache->mutex held */
+static gboolean _sim_identity_can_store(telephony_sim_cache *cache, guint generation)
+{
+	/*
+	 * Without the status subscription the cache could never be dropped.
+	 * Values read while the card is locked or not ready yet may be empty
+	 * or stale, so only those of an initialized card are kept.
+	 */
+	return cache->status_changed_id && cache->generation == generation
+		&& cache->status_valid && cache->status == TAPI_SIM_STATUS_SIM_INIT_COMPLETED;
+}
+
+static gboolean _sim_identity_lookup_string(telephony_data *data,
+	telephony_sim_identity_e item, char **value)
+{
+	telephony_sim_cache *cache = &data->sim_cache;
+	gboolean found = FALSE;
+
+	g_mutex_lock(&cache->mutex);
+	if (cache->identity_valid & item) {
+		*value = g_strdup(*_sim_cache_identity_string(cache, item));
+		found = TRUE;
+	}
+	g_mutex_unlock(&cache->mutex);
+
+	return found;
+}
+
+static void _sim_identity_store_string(telephony_data *data, guint generation,
+	telephony_sim_identity_e item, const char *value)
+{
+	telephony_sim_cache *cache = &data->sim_cache;
+	char **field;
+
+	g_mutex_lock(&cache->mutex);
+	if (_sim_identity_can_store(cache, generation)) {
+		field = _sim_cache_identity_string(cache, item);
+		g_free(*field);
+		*field = g_strdup(value);
+		cache->identity_valid |= item;
+	}
+	g_mutex_unlock(&cache->mutex);
+}
+
+static void _sim_make_subscriber_id(telephony_sim_imsi_s *imsi)
+{
+	SHA256_CTX ctx;
+	char *imsi_str;
+	unsigned char md[SHA256_DIGEST_LENGTH];
+	int i;
+
+	imsi_str = g_strdup_printf("%s%s%s", imsi->mcc, imsi->mnc, imsi->msin);
+
+	SHA256_Init(&ctx);
+	SHA256_Update(&ctx, imsi_str, strlen(imsi_str));
+	SHA256_Final(md, &ctx);
+
+	for (i = 0; i < SHA256_DIGEST_LENGTH; i++)
+		snprintf(imsi->subscriber_id + (i * 2), 3, "%02x", md[i]);
+	g_free(imsi_str);
+}
+
+/* Returns TAPI error code like tel_get_sim_imsi() */
+static int _get_sim_imsi(telephony_data *data, telephony_sim_imsi_s *imsi)
+{
+	telephony_sim_cache *cache = &data->sim_cache;
+	TelSimImsiInfo_t imsi_info;
+	guint generation;
+	int ret;
+
+	g_mutex_lock(&cache->mutex);
+	if (cache->identity_valid & SIM_IDENTITY_IMSI) {
+		*imsi = cache->imsi;
+		g_mutex_unlock(&cache->mutex);
+		return TAPI_API_SUCCESS;
+	}
+	generation = cache->generation;
+	g_mutex_unlock(&cache->mutex);
+
+	ret = tel_get_sim_imsi(data->tapi_h, &imsi_info);
+	if (ret == TAPI_API_SUCCESS) {
+		memset(imsi, 0, sizeof(*imsi));
+		g_strlcpy(imsi->mcc, imsi_info.szMcc, sizeof(imsi->mcc));
+		g_strlcpy(imsi->mnc, imsi_info.szMnc, sizeof(imsi->mnc));
+		g_strlcpy(imsi->msin, imsi_info.szMsin, sizeof(imsi->msin));
+		_sim_make_subscriber_id(imsi);
+
+		g_mutex_lock(&cache->mutex);
+		if (_sim_identity_can_store(cache, generation)) {
+			cache->imsi = *imsi;
+			cache->identity_valid |= SIM_IDENTITY_IMSI;
+		}
+		g_mutex_unlock(&cache->mutex);
+	}
+
+	return ret;
+}
+
+static void _on_sim_status_changed(GDBusConnection *connection,
+	const gchar *sender_name, const gchar *object_path,
+	const gchar *interface_name, const gchar *signal_name,
+	GVariant *parameters, gpointer user_data)
+{
+	telephony_sim_cache *cache = &((telephony_data *)user_data)->sim_cache;
+	GVariant *value;
+	int status;
+
+	if (g_variant_n_children(parameters) == 0)
+		return;
+
+	value = g_variant_get_child_value(parameters, 0);
+	if (_telephony_variant_get_int(value, &status)) {
+		g_mutex_lock(&cache->mutex);
+		/* Every transition drops the identity, including the one to INIT_COMPLETED */
+		if (!cache->status_valid || cache->status != status)
+			_sim_cache_drop_identity(cache);
+		cache->status = status;
+		cache->status_valid = TRUE;
+		cache->generation++;
+		g_mutex_unlock(&cache->mutex);
+		LOGI("SIM status: [%d]", status);
+	}
+	g_variant_unref(value);
+}
+
+void _telephony_sim_cache_init(telephony_data *data)
+{
+	telephony_sim_cache *cache = &data->sim_cache;
+	gchar **noti = g_strsplit(TAPI_NOTI_SIM_STATUS, ":", 2);
+
+	g_mutex_init(&cache->mutex);
+
+	/* TAPI notification names are "<dbus interface>:<dbus signal>" */
+	if (noti[0] && noti[1]) {
+		cache->status_changed_id = g_dbus_connection_signal_subscribe(
+			data->tapi_h->dbus_connection, DBUS_TELEPHONY_SERVICE,
+			noti[0], noti[1], data->tapi_h->path, NULL,
+			G_DBUS_SIGNAL_FLAGS_NONE, _on_sim_status_changed, data, NULL);
+	}
+	if (cache->status_changed_id == 0)
+		LOGE("SIM status cache is disabled");
+	g_strfreev(noti);
+}
+
+void _telephony_sim_cache_invalidate(telephony_data *data)
+{
+	telephony_sim_cache *cache = &data->sim_cache;
+
+	g_mutex_lock(&cache->mutex);
+	_sim_cache_drop_identity(cache);
+	cache->status_valid = FALSE;
+	cache->generation++;
+	g_mutex_unlock(&cache->mutex);
+}
+
+void _telephony_sim_cache_deinit(telephony_data *data)
+{
+	telephony_sim_cache *cache = &data->sim_cache;
+
+	if (cache->status_changed_id) {
+		g_dbus_connection_signal_unsubscribe(data->tapi_h->dbus_connection,
+			cache->status_changed_id);
+		cache->status_changed_id = 0;
+	}
+	_telephony_sim_cache_invalidate(data);
+	g_mutex_clear(&cache->mutex);
+}
+
+/* Must be called with cache->mutex held */
+static void _sim_cache_store_status(telephony_sim_cache *cache,
+	guint generation, TelSimCardStatus_t status, int card_changed)
+{
+	/* Do not overwrite a status which has been notified while it was fetched */
+	gboolean store = cache->status_changed_id && cache->generation == generation;
+
+	/*
+	 * The card changed flag keeps its value for the whole session, so only
+	 * a flip means that a different card has been inserted meanwhile.
+	 */
+	if (status != TAPI_SIM_STATUS_SIM_INIT_COMPLETED
+			|| (cache->card_changed_valid && cache->card_changed != card_changed)) {
+		_sim_cache_drop_identity(cache);
+		cache->generation++;
+	}
+	cache->card_changed = card_changed;
+	cache->card_changed_valid = TRUE;
+
+	if (store) {
+		cache->status = status;
+		cache->status_valid = TRUE;
+	}
+}
+
+/*
+ * Returns TAPI error code like tel_get_sim_init_info().
+ * The telephony daemon is asked only until the first SIM status is known.
+ */
+static int _get_sim_status(telephony_data *data, TelSimCardStatus_t *sim_card_state)
+{
+	telephony_sim_cache *cache = &data->sim_cache;
+	int card_changed = 0;
+	guint generation;
+	int ret;
+
+	g_mutex_lock(&cache->mutex);
+	if (cache->status_valid) {
+		*sim_card_state = cache->status;
+		g_mutex_unlock(&cache->mutex);
+		return TAPI_API_SUCCESS;
+	}
+	generation = cache->generation;
+	g_mutex_unlock(&cache->mutex);
+
+	ret = tel_get_sim_init_info(data->tapi_h, sim_card_state, &card_changed);
+	if (ret == TAPI_API_SUCCESS) {
+		g_mutex_lock(&cache->mutex);
+		_sim_cache_store_status(cache, generation, *sim_card_state, card_changed);
+		g_mutex_unlock(&cache->mutex);
+	}
+
+	return ret;
+}
+
 static telephony_error_e _convert_dbus_errmsg_to_sim_error(gchar *err_msg)
 {
 	telephony_error_e ret = TELEPHONY_ERROR_OPERATION_FAILED;
@@ -83,6 +347,30 @@ static telephony_error_e _convert_dbus_errmsg_to_sim_error(gchar *err_msg)
 	return ret;
 }
 
+/* Shared by the getters of the IMSI parts, they all come from one IMSI read */
+static int _get_sim_imsi_info(telephony_h handle, telephony_sim_imsi_s *imsi)
+{
+	int error_code = TELEPHONY_ERROR_NONE;
+	TelSimCardStatus_t sim_card_state = TAPI_SIM_STATUS_UNKNOWN;
+
+	GET_SIM_STATUS(handle, sim_card_state);
+
+	if (sim_card_state != TAPI_SIM_STATUS_SIM_INIT_COMPLETED) {
+		error_code = TELEPHONY_ERROR_SIM_NOT_AVAILABLE;
+	} else {
+		int ret = _get_sim_imsi((telephony_data *)handle, imsi);
+		if (ret == TAPI_API_ACCESS_DENIED) {
+			LOGE("PERMISSION_DENIED");
+			error_code = TELEPHONY_ERROR_PERMISSION_DENIED;
+		} else if (ret != TAPI_API_SUCCESS) {
+			LOGE("OPERATION_FAILED");
+			error_code = TELEPHONY_ERROR_OPERATION_FAILED;
+		}
+	}
+
+	return error_code;
+}
+
 int telephony_sim_get_icc_id(telephony_h handle, char **icc_id)
 {
 	int error_code = TELEPHONY_ERROR_NONE;
@@ -94,7 +382,7 @@ int telephony_sim_get_icc_id(telephony_h handle, char **icc_id)
 	tapi_h = ((telephony_data *)handle)->tapi_h;
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(icc_id);
-	GET_SIM_STATUS(tapi_h, sim_card_state);
+	GET_SIM_STATUS(handle, sim_card_state);
 
 	*icc_id = NULL;
 	if (sim_card_state == TAPI_SIM_STATUS_CARD_ERROR
@@ -103,11 +391,12 @@ int telephony_sim_get_icc_id(telephony_h handle, char **icc_id)
 			|| sim_card_state == TAPI_SIM_STATUS_CARD_REMOVED
 			|| sim_card_state == TAPI_SIM_STATUS_UNKNOWN) {
 		error_code = TELEPHONY_ERROR_SIM_NOT_AVAILABLE;
-	} else {
+	} else if (!_sim_identity_lookup_string((telephony_data *)handle, SIM_IDENTITY_ICC_ID, icc_id)) {
 		GError *gerr = NULL;
 		GVariant *sync_gv = NULL;
 		gchar *iccid = NULL;
 		TelSimAccessResult_t result = TAPI_SIM_ACCESS_SUCCESS;
+		guint generation = _sim_identity_get_generation((telephony_data *)handle);
 
 		sync_gv = g_dbus_connection_call_sync(tapi_h->dbus_connection,
 			DBUS_TELEPHONY_SERVICE, tapi_h->path, DBUS_TELEPHONY_SIM_INTERFACE,
@@ -120,6 +409,8 @@ int telephony_sim_get_icc_id(telephony_h handle, char **icc_id)
 					*icc_id = g_strdup_printf("%s", iccid);
 				else
 					*icc_id = g_strdup_printf("%s", "");
+				_sim_identity_store_string((telephony_data *)handle, generation,
+					SIM_IDENTITY_ICC_ID, *icc_id);
 			} else {
 				error_code = TELEPHONY_ERROR_OPERATION_FAILED;
 			}
@@ -136,8 +427,8 @@ int telephony_sim_get_icc_id(telephony_h handle, char **icc_id)
 
 int telephony_sim_get_operator(telephony_h handle, char **sim_operator)
 {
-	int error_code = TELEPHONY_ERROR_NONE;
-	TelSimCardStatus_t sim_card_state = TAPI_SIM_STATUS_UNKNOWN;
+	int error_code;
+	telephony_sim_imsi_s imsi;
 	TapiHandle *tapi_h;
 
 	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
@@ -145,24 +436,12 @@ int telephony_sim_get_operator(telephony_h handle, char **sim_operator)
 	tapi_h = ((telephony_data *)handle)->tapi_h;
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(sim_operator);
-	GET_SIM_STATUS(tapi_h, sim_card_state);
 
 	*sim_operator = NULL;
-	if (sim_card_state != TAPI_SIM_STATUS_SIM_INIT_COMPLETED) {
-		error_code = TELEPHONY_ERROR_SIM_NOT_AVAILABLE;
-	} else {
-		TelSimImsiInfo_t sim_imsi_info;
-		int ret = tel_get_sim_imsi(tapi_h, &sim_imsi_info);
-		if (ret == TAPI_API_SUCCESS) {
-			*sim_operator = g_strdup_printf("%s%s", sim_imsi_info.szMcc, sim_imsi_info.szMnc);
-			LOGI("SIM operator: [%s]", *sim_operator);
-		} else if (ret == TAPI_API_ACCESS_DENIED) {
-			LOGE("PERMISSION_DENIED");
-			error_code = TELEPHONY_ERROR_PERMISSION_DENIED;
-		} else {
-			LOGE("OPERATION_FAILED");
-			error_code = TELEPHONY_ERROR_OPERATION_FAILED;
-		}
+	error_code = _get_sim_imsi_info(handle, &imsi);
+	if (error_code == TELEPHONY_ERROR_NONE) {
+		*sim_operator = g_strdup_printf("%s%s", imsi.mcc, imsi.mnc);
+		LOGI("SIM operator: [%s]", *sim_operator);
 	}
 
 	return error_code;
@@ -170,8 +449,8 @@ int telephony_sim_get_operator(telephony_h handle, char **sim_operator)
 
 int telephony_sim_get_msin(telephony_h handle, char **msin)
 {
-	int error_code = TELEPHONY_ERROR_NONE;
-	TelSimCardStatus_t sim_card_state = TAPI_SIM_STATUS_UNKNOWN;
+	int error_code;
+	telephony_sim_imsi_s imsi;
 	TapiHandle *tapi_h;
 
 	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
@@ -179,24 +458,11 @@ int telephony_sim_get_msin(telephony_h handle, char **msin)
 	tapi_h = ((telephony_data *)handle)->tapi_h;
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(msin);
-	GET_SIM_STATUS(tapi_h, sim_card_state);
 
 	*msin = NULL;
-	if (sim_card_state != TAPI_SIM_STATUS_SIM_INIT_COMPLETED) {
-		error_code = TELEPHONY_ERROR_SIM_NOT_AVAILABLE;
-	} else {
-		TelSimImsiInfo_t sim_imsi_info;
-		int ret = tel_get_sim_imsi(tapi_h, &sim_imsi_info);
-		if (ret == TAPI_API_SUCCESS) {
-			*msin = g_strdup_printf("%s", sim_imsi_info.szMsin);
-		} else if (ret == TAPI_API_ACCESS_DENIED) {
-			LOGE("PERMISSION_DENIED");
-			error_code = TELEPHONY_ERROR_PERMISSION_DENIED;
-		} else {
-			LOGE("OPERATION_FAILED");
-			error_code = TELEPHONY_ERROR_OPERATION_FAILED;
-		}
-	}
+	error_code = _get_sim_imsi_info(handle, &imsi);
+	if (error_code == TELEPHONY_ERROR_NONE)
+		*msin = g_strdup_printf("%s", imsi.msin);
 
 	return error_code;
 }
@@ -212,7 +478,7 @@ int telephony_sim_get_spn(telephony_h handle, char **spn)
 	tapi_h = ((telephony_data *)handle)->tapi_h;
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(spn);
-	GET_SIM_STATUS(tapi_h, sim_card_state);
+	GET_SIM_STATUS(handle, sim_card_state);
 
 	*spn = NULL;
 	if (sim_card_state == TAPI_SIM_STATUS_CARD_ERROR
@@ -221,12 +487,13 @@ int telephony_sim_get_spn(telephony_h handle, char **spn)
 			|| sim_card_state == TAPI_SIM_STATUS_CARD_REMOVED
 			|| sim_card_state == TAPI_SIM_STATUS_UNKNOWN) {
 		error_code = TELEPHONY_ERROR_SIM_NOT_AVAILABLE;
-	} else {
+	} else if (!_sim_identity_lookup_string((telephony_data *)handle, SIM_IDENTITY_SPN, spn)) {
 		GError *gerr = NULL;
 		GVariant *sync_gv = NULL;
 		TelSimAccessResult_t result = TAPI_SIM_ACCESS_SUCCESS;
 		gchar *spn_str = NULL;
 		guchar dc = 0;
+		guint generation = _sim_identity_get_generation((telephony_data *)handle);
 
 		sync_gv = g_dbus_connection_call_sync(tapi_h->dbus_connection,
 			DBUS_TELEPHONY_SERVICE, tapi_h->path, DBUS_TELEPHONY_SIM_INTERFACE,
@@ -242,6 +509,8 @@ int telephony_sim_get_spn(telephony_h handle, char **spn)
 					*spn = g_strdup_printf("%s", "");
 					LOGI("SPN: [%s]", *spn);
 				}
+				_sim_identity_store_string((telephony_data *)handle, generation,
+					SIM_IDENTITY_SPN, *spn);
 			} else {
 				error_code = TELEPHONY_ERROR_OPERATION_FAILED;
 			}
@@ -262,6 +531,8 @@ int telephony_sim_is_changed(telephony_h handle, bool *is_changed)
 	TelSimCardStatus_t sim_card_state = 0x00;
 	int error_code = TELEPHONY_ERROR_NONE;
 	int ret;
+	guint generation;
+	telephony_sim_cache *cache;
 	TapiHandle *tapi_h;
 
 	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
@@ -270,8 +541,15 @@ int telephony_sim_is_changed(telephony_h handle, bool *is_changed)
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(is_changed);
 
+	cache = &((telephony_data *)handle)->sim_cache;
+	generation = _sim_identity_get_generation((telephony_data *)handle);
+
 	ret = tel_get_sim_init_info(tapi_h, &sim_card_state, &card_changed);
 	if (ret == TAPI_API_SUCCESS) {
+		g_mutex_lock(&cache->mutex);
+		_sim_cache_store_status(cache, generation, sim_card_state, card_changed);
+		g_mutex_unlock(&cache->mutex);
+
 		if (sim_card_state == TAPI_SIM_STATUS_SIM_INIT_COMPLETED) {
 			*is_changed = card_changed;
 		} else {
@@ -300,7 +578,7 @@ int telephony_sim_get_state(telephony_h handle, telephony_sim_state_e *sim_state
 	tapi_h = ((telephony_data *)handle)->tapi_h;
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(sim_state);
-	GET_SIM_STATUS(tapi_h, sim_card_state);
+	GET_SIM_STATUS(handle, sim_card_state);
 
 	switch (sim_card_state) {
 	case TAPI_SIM_STATUS_CARD_ERROR:
@@ -337,12 +615,25 @@ int telephony_sim_get_application_list(telephony_h handle, unsigned int *app_lis
 	TapiHandle *tapi_h;
 	unsigned char tapi_app_list;
 	int ret;
+	guint generation;
+	telephony_sim_cache *cache;
 
 	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
 	CHECK_INPUT_PARAMETER(handle);
 	tapi_h = ((telephony_data *)handle)->tapi_h;
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(app_list);
+	cache = &((telephony_data *)handle)->sim_cache;
+
+	g_mutex_lock(&cache->mutex);
+	if (cache->identity_valid & SIM_IDENTITY_APP_LIST) {
+		*app_list = cache->app_list;
+		g_mutex_unlock(&cache->mutex);
+		LOGI("SIM Application List: [0x%x]", *app_list);
+		return TELEPHONY_ERROR_NONE;
+	}
+	generation = cache->generation;
+	g_mutex_unlock(&cache->mutex);
 
 	ret = tel_get_sim_application_list(tapi_h, &tapi_app_list);
 	if (ret == TAPI_API_ACCESS_DENIED) {
@@ -354,6 +645,14 @@ int telephony_sim_get_application_list(telephony_h handle, unsigned int *app_lis
 	}
 
 	*app_list = (unsigned int)tapi_app_list;
+
+	g_mutex_lock(&cache->mutex);
+	if (_sim_identity_can_store(cache, generation)) {
+		cache->app_list = *app_list;
+		cache->identity_valid |= SIM_IDENTITY_APP_LIST;
+	}
+	g_mutex_unlock(&cache->mutex);
+
 	LOGI("SIM Application List: [0x%x]", *app_list);
 	return TELEPHONY_ERROR_NONE;
 }
@@ -364,6 +663,7 @@ int telephony_sim_get_subscriber_number(telephony_h handle, char **subscriber_nu
 	GError *gerr = NULL;
 	GVariant *sync_gv = NULL;
 	TelSimAccessResult_t result = TAPI_SIM_ACCESS_SUCCESS;
+	guint generation;
 	TapiHandle *tapi_h;
 
 	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
@@ -373,6 +673,10 @@ int telephony_sim_get_subscriber_number(telephony_h handle, char **subscriber_nu
 	CHECK_INPUT_PARAMETER(subscriber_number);
 
 	*subscriber_number = NULL;
+	if (_sim_identity_lookup_string((telephony_data *)handle, SIM_IDENTITY_MSISDN, subscriber_number))
+		return TELEPHONY_ERROR_NONE;
+
+	generation = _sim_identity_get_generation((telephony_data *)handle);
 	sync_gv = g_dbus_connection_call_sync(tapi_h->dbus_connection,
 		DBUS_TELEPHONY_SERVICE, tapi_h->path, DBUS_TELEPHONY_SIM_INTERFACE,
 		"GetMSISDN", NULL, NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, &gerr);
@@ -400,6 +704,8 @@ int telephony_sim_get_subscriber_number(telephony_h handle, char **subscriber_nu
 			if (!*subscriber_number)
 				*subscriber_number = g_strdup_printf("%s", "");
 			g_variant_iter_free(iter);
+			_sim_identity_store_string((telephony_data *)handle, generation,
+				SIM_IDENTITY_MSISDN, *subscriber_number);
 		} else {
 			error_code = TELEPHONY_ERROR_OPERATION_FAILED;
 		}
@@ -414,8 +720,8 @@ int telephony_sim_get_subscriber_number(telephony_h handle, char **subscriber_nu
 
 int telephony_sim_get_subscriber_id(telephony_h handle, char **subscriber_id)
 {
-	int error_code = TELEPHONY_ERROR_NONE;
-	TelSimCardStatus_t sim_card_state = TAPI_SIM_STATUS_UNKNOWN;
+	int error_code;
+	telephony_sim_imsi_s imsi;
 	TapiHandle *tapi_h;
 
 	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
@@ -423,40 +729,34 @@ int telephony_sim_get_subscriber_id(telephony_h handle, char **subscriber_id)
 	tapi_h = ((telephony_data *)handle)->tapi_h;
 	CHECK_INPUT_PARAMETER(tapi_h);
 	CHECK_INPUT_PARAMETER(subscriber_id);
-	GET_SIM_STATUS(tapi_h, sim_card_state);
 
 	*subscriber_id = NULL;
-	if (sim_card_state != TAPI_SIM_STATUS_SIM_INIT_COMPLETED) {
-		error_code = TELEPHONY_ERROR_SIM_NOT_AVAILABLE;
+	error_code = _get_sim_imsi_info(handle, &imsi);
+	if (error_code == TELEPHONY_ERROR_NONE) {
+		*subscriber_id = g_strdup_printf("%s", imsi.subscriber_id);
+		LOGI("Subscriber ID: [%s]", *subscriber_id);
 	} else {
-		TelSimImsiInfo_t imsi_info;
-		error_code = tel_get_sim_imsi(tapi_h, &imsi_info);
-		if (error_code == TAPI_API_SUCCESS) {
-			SHA256_CTX ctx;
-			char *imsi;
-			unsigned char md[SHA256_DIGEST_LENGTH];
-			int i;
-
-			imsi = g_strdup_printf("%s%s%s",
-				imsi_info.szMcc, imsi_info.szMnc, imsi_info.szMsin);
-
-			SHA256_Init(&ctx);
-			SHA256_Update(&ctx, imsi, strlen(imsi));
-			SHA256_Final(md, &ctx);
-
-			*subscriber_id = g_malloc0(SHA256_DIGEST_LENGTH * 2 + 1);
-			for (i = 0; i < SHA256_DIGEST_LENGTH; i++)
-				snprintf(*subscriber_id + (i * 2), 3,  "%02x", md[i]);
-			LOGI("Subscriber ID: [%s]", *subscriber_id);
-			g_free(imsi);
-		} else if (error_code == TAPI_API_ACCESS_DENIED) {
-			LOGE("get_subscriber_id: PERMISSION_DENIED");
-			error_code = TELEPHONY_ERROR_PERMISSION_DENIED;
-		} else {
-			LOGE("get_subscriber_id: OPERATION_FAILED");
-			error_code = TELEPHONY_ERROR_OPERATION_FAILED;
-		}
+		LOGE("get_subscriber_id: failed (0x%x)", error_code);
 	}
 
 	return error_code;
 }
+
+int telephony_sim_get_imsi_info(telephony_h handle, telephony_sim_imsi_s *imsi_info)
+{
+	int error_code;
+	TapiHandle *tapi_h;
+
+	CHECK_TELEPHONY_SUPPORTED(TELEPHONY_FEATURE);
+	CHECK_INPUT_PARAMETER(handle);
+	tapi_h = ((telephony_data *)handle)->tapi_h;
+	CHECK_INPUT_PARAMETER(tapi_h);
+	CHECK_INPUT_PARAMETER(imsi_info);
+
+	memset(imsi_info, 0, sizeof(*imsi_info));
+	error_code = _get_sim_imsi_info(handle, imsi_info);
+	if (error_code == TELEPHONY_ERROR_NONE)
+		LOGI("SIM IMSI: MCC[%s] MNC[%s]", imsi_info->mcc, imsi_info->mnc);
+
+	return error_code;
+}
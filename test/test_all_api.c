@@ -16,6 +16,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <poll.h>
 #include <glib.h>
 #include <dlog.h>
 
@@ -26,6 +27,8 @@
 #endif
 #define LOG_TAG "CAPI_TELEPHONY_TEST"
 
+#define NOTI_RECORD_PATH "/tmp/telephony_noti.rec"
+
 static GMainLoop *event_loop;
 static telephony_handle_list_s handle_list;
 
@@ -40,7 +43,7 @@ static int network_noti_tbl[] = {
 	TELEPHONY_NOTI_NETWORK_DEFAULT_SUBSCRIPTION
 };
 
-static int call_noti_tbl[] = {
+static telephony_noti_e call_noti_tbl[] = {
 	TELEPHONY_NOTI_VOICE_CALL_STATUS_IDLE,
 	TELEPHONY_NOTI_VOICE_CALL_STATUS_ACTIVE,
 	TELEPHONY_NOTI_VOICE_CALL_STATUS_HELD,
@@ -50,6 +53,23 @@ static int call_noti_tbl[] = {
 	TELEPHONY_NOTI_CALL_PREFERRED_VOICE_SUBSCRIPTION
 };
 
+static void network_batch_cb(telephony_h handle, const telephony_event_s *events, size_t count, void *user_data)
+{
+	size_t i;
+
+	LOGI("Noti!!! Network batch of [%zu] events", count);
+	for (i = 0; i < count; i++)
+		LOGI("noti_id: [%d], int_value: [%d]", events[i].noti_id, events[i].data.int_value);
+}
+
+static bool network_history_cb(unsigned long long timestamp, const telephony_network_snapshot_s *snapshot, void *user_data)
+{
+	LOGI("[%llu] cell_id:[%d] lac:[%d] rssi:[%d] mcc:[%s] mnc:[%s] service_state:[%d] ps_type:[%d]",
+		timestamp, snapshot->cell_id, snapshot->lac, snapshot->rssi, snapshot->mcc, snapshot->mnc,
+		snapshot->service_state, snapshot->ps_type);
+	return true;
+}
+
 static const char *_mapping_sim_state(telephony_sim_state_e sim_state)
 {
 	switch (sim_state) {
@@ -66,7 +86,11 @@ static const char *_mapping_sim_state(telephony_sim_state_e sim_state)
 
 static void sim_noti_cb(telephony_h handle, telephony_noti_e noti_id, void *data, void *user_data)
 {
+	telephony_noti_timing_s timing;
+
 	LOGI("Noti!! SIM status: [%d]", *(int *)data);
+	if (telephony_noti_get_timing(&timing) == TELEPHONY_ERROR_NONE)
+		LOGI("Delivered [%llu] us after reception", timing.callback_start - timing.received);
 }
 
 static const char *_mapping_service_state(telephony_network_service_state_e service_state)
@@ -312,6 +336,7 @@ int main()
 	unsigned int app_list = 0;
 	char *subscriber_number = NULL;
 	char *subscriber_id = NULL;
+	telephony_sim_imsi_s imsi_info;
 	bool is_changed = FALSE;
 
 	/* Network value */
@@ -319,6 +344,8 @@ int main()
 	int lac = 0;
 	char *mcc = NULL;
 	char *mnc = NULL;
+	char plmn_mcc[TELEPHONY_NETWORK_MCC_LEN_MAX + 1];
+	char plmn_mnc[TELEPHONY_NETWORK_MNC_LEN_MAX + 1];
 	char *network_name = NULL;
 	bool roaming_status;
 	telephony_network_rssi_e rssi = 0;
@@ -328,6 +355,10 @@ int main()
 	telephony_network_default_subs_e default_sub = 0;
 	telephony_network_name_option_e network_name_option = 0;
 	telephony_network_ps_type_e ps_type = 0;
+	unsigned int hit_count = 0;
+	unsigned int miss_count = 0;
+	telephony_network_snapshot_s snapshot;
+	unsigned long long history_start = 0;
 
 	/* Call value */
 	telephony_call_state_e call_state = 0;
@@ -335,6 +366,21 @@ int main()
 	telephony_call_h *call_list;
 	unsigned int count = 0;
 
+	/* Event queue value */
+	telephony_event_queue_h event_queue = NULL;
+	telephony_event_s events[16];
+	telephony_noti_batch_h network_batch = NULL;
+	telephony_noti_policy_s rssi_policy = { 1000, true };
+	telephony_noti_stats_s noti_stats;
+	telephony_noti_queue_stats_s queue_stats;
+	telephony_noti_slow_callback_s slow_callbacks[TELEPHONY_NOTI_SLOW_CALLBACKS_MAX];
+	telephony_noti_e network_batch_tbl[] = {
+		TELEPHONY_NOTI_NETWORK_CELLID,
+		TELEPHONY_NOTI_NETWORK_SIGNALSTRENGTH_LEVEL,
+		TELEPHONY_NOTI_NETWORK_PS_TYPE
+	};
+	unsigned int event_count = 0;
+
 	/* Modem value */
 	char *imei = NULL;
 	telephony_modem_power_status_e power_status = 0;
@@ -421,6 +467,13 @@ int main()
 		free(subscriber_id);
 	}
 
+	ret_value = telephony_sim_get_imsi_info(handle_list.handle[0], &imsi_info);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("telephony_sim_get_imsi_info() failed!!! [%d]", ret_value);
+	else
+		LOGI("IMSI info: MCC[%s] MNC[%s] MSIN[%s] Subscriber ID[%s]",
+			imsi_info.mcc, imsi_info.mnc, imsi_info.msin, imsi_info.subscriber_id);
+
 	/* Network API */
 	ret_value = telephony_network_get_cell_id(handle_list.handle[0], &cell_id);
 	if (ret_value != TELEPHONY_ERROR_NONE)
@@ -450,6 +503,12 @@ int main()
 		free(mnc);
 	}
 
+	ret_value = telephony_network_get_plmn(handle_list.handle[0], plmn_mcc, plmn_mnc);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("telephony_network_get_plmn() failed!!! [%d]", ret_value);
+	else
+		LOGI("MCC is [%s], MNC is [%s]", plmn_mcc, plmn_mnc);
+
 	ret_value = telephony_network_get_network_name(handle_list.handle[0], &network_name);
 	if (ret_value != TELEPHONY_ERROR_NONE) {
 		LOGE("telephony_network_get_network_name() failed!!! [%d]", ret_value);
@@ -506,6 +565,21 @@ int main()
 	else
 		LOGI("Default subscription is [%s]", _mapping_default_sub(default_sub));
 
+	ret_value = telephony_network_get_snapshot(handle_list.handle[0], &snapshot);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("telephony_network_get_snapshot() failed!!! [%d]", ret_value);
+	else
+		LOGI("Snapshot: cell_id[%d] lac[%d] rssi[%d] plmn[%s%s] name[%s] type[%s] service state[%s]",
+			snapshot.cell_id, snapshot.lac, snapshot.rssi, snapshot.mcc, snapshot.mnc,
+			snapshot.network_name, _mapping_network_type(snapshot.network_type),
+			_mapping_service_state(snapshot.service_state));
+
+	ret_value = telephony_network_get_cache_stats(handle_list.handle[0], &hit_count, &miss_count);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("telephony_network_get_cache_stats() failed!!! [%d]", ret_value);
+	else
+		LOGI("Network cache hit: [%u], miss: [%u]", hit_count, miss_count);
+
 	/* Call API */
 	ret_value = telephony_call_get_voice_call_state(handle_list.handle[0], &call_state);
 	if (ret_value != TELEPHONY_ERROR_NONE)
@@ -576,16 +650,104 @@ int main()
 			LOGE("Set noti failed!!!");
 	}
 
-	for (i = 0; i < (sizeof(call_noti_tbl) / sizeof(int)); i++) {
-		ret_value = telephony_set_noti_cb(handle_list.handle[0], call_noti_tbl[i], call_noti_cb, NULL);
-		if (ret_value != TELEPHONY_ERROR_NONE)
-			LOGE("Set noti failed!!!");
-	}
+	ret_value = telephony_set_noti_cb_many(handle_list.handle[0], call_noti_tbl,
+		sizeof(call_noti_tbl) / sizeof(telephony_noti_e), call_noti_cb, NULL);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("Set noti many failed!!!");
+
+	/* Enabled by default, repeated values are not delivered */
+	ret_value = telephony_set_noti_filter(handle_list.handle[0], true);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("telephony_set_noti_filter() failed!!!");
+
+	ret_value = telephony_set_noti_queue_policy(handle_list.handle[0], TELEPHONY_NOTI_CLASS_NETWORK,
+		16, TELEPHONY_NOTI_OVERFLOW_DROP_OLDEST);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("telephony_set_noti_queue_policy() failed!!!");
+
+	ret_value = telephony_set_noti_callback_budget(handle_list.handle[0], 10000);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("telephony_set_noti_callback_budget() failed!!!");
+
+	ret_value = telephony_set_noti_cb_with_policy(handle_list.handle[0], TELEPHONY_NOTI_NETWORK_SIGNALSTRENGTH_LEVEL,
+		&rssi_policy, network_noti_cb, NULL);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("Set noti with policy failed!!!");
+
+	ret_value = telephony_set_noti_batch_cb(handle_list.handle[0], network_batch_tbl,
+		sizeof(network_batch_tbl) / sizeof(telephony_noti_e), 100, network_batch_cb, NULL, &network_batch);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("Set noti batch failed!!!");
+
+	ret_value = telephony_network_history_enable(handle_list.handle[0], 256);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("telephony_network_history_enable() failed!!!");
+	history_start = g_get_monotonic_time();
+
+	ret_value = telephony_noti_recorder_start(NOTI_RECORD_PATH, 64 * 1024);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("telephony_noti_recorder_start() failed!!!");
 
 	LOGI("If telephony status is changed, then callback function will be called");
 	event_loop = g_main_loop_new(NULL, FALSE);
 	g_main_loop_run(event_loop);
 
+	ret_value = telephony_noti_recorder_stop();
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("telephony_noti_recorder_stop() failed!!!");
+
+	ret_value = telephony_network_history_at(handle_list.handle[0], history_start, &snapshot);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("telephony_network_history_at() failed!!! [%d]", ret_value);
+	else
+		LOGI("Network at start, cell_id:[%d] rssi:[%d]", snapshot.cell_id, snapshot.rssi);
+
+	ret_value = telephony_network_history_foreach(handle_list.handle[0], history_start,
+		g_get_monotonic_time(), network_history_cb, NULL);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("telephony_network_history_foreach() failed!!! [%d]", ret_value);
+
+	ret_value = telephony_network_history_disable(handle_list.handle[0]);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("telephony_network_history_disable() failed!!!");
+
+	/* Delivered again to the callbacks above once the main loop runs, as fast as possible */
+	ret_value = telephony_noti_replay(&handle_list, NOTI_RECORD_PATH, false, &count);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("telephony_noti_replay() failed!!!");
+	else
+		LOGI("Replaying notifications: [%u]", count);
+
+	ret_value = telephony_get_noti_stats(handle_list.handle[0], TELEPHONY_NOTI_NETWORK_SIGNALSTRENGTH_LEVEL, &noti_stats);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("telephony_get_noti_stats() failed!!!");
+	else
+		LOGI("Signal strength noti, delivered: [%u], suppressed: [%u], filtered: [%u]",
+			noti_stats.delivered, noti_stats.suppressed, noti_stats.filtered);
+
+	ret_value = telephony_get_noti_queue_stats(handle_list.handle[0], TELEPHONY_NOTI_CLASS_NETWORK, &queue_stats);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("telephony_get_noti_queue_stats() failed!!!");
+	else
+		LOGI("Network noti queue, depth: [%u], high water: [%u], dropped: [%u]",
+			queue_stats.depth, queue_stats.high_water, queue_stats.dropped);
+
+	ret_value = telephony_get_noti_slow_callbacks(handle_list.handle[0], slow_callbacks,
+		TELEPHONY_NOTI_SLOW_CALLBACKS_MAX, &count);
+	if (ret_value != TELEPHONY_ERROR_NONE) {
+		LOGE("telephony_get_noti_slow_callbacks() failed!!!");
+	} else {
+		for (i = 0; i < count; i++)
+			LOGI("Slow callback [%p] of noti_id [%d], count: [%u], max: [%u] us",
+				slow_callbacks[i].cb, slow_callbacks[i].noti_id,
+				slow_callbacks[i].count, slow_callbacks[i].max_duration_us);
+	}
+
+	/* Set by the network_noti_tbl loop and with a policy */
+	ret_value = telephony_unset_noti_cb(handle_list.handle[0], TELEPHONY_NOTI_NETWORK_SIGNALSTRENGTH_LEVEL);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("Unset noti failed!!!");
+
 	ret_value = telephony_unset_noti_cb(handle_list.handle[0], TELEPHONY_NOTI_SIM_STATUS);
 	if (ret_value != TELEPHONY_ERROR_NONE)
 		LOGE("Unset noti failed!!!");
@@ -596,15 +758,57 @@ int main()
 			LOGE("Unset noti failed!!!");
 	}
 
-	for (i = 0; i < (sizeof(call_noti_tbl) / sizeof(int)); i++) {
-		ret_value = telephony_unset_noti_cb(handle_list.handle[0], call_noti_tbl[i]);
+	ret_value = telephony_unset_noti_cb_many(handle_list.handle[0], call_noti_tbl,
+		sizeof(call_noti_tbl) / sizeof(telephony_noti_e));
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("Unset noti many failed!!!");
+
+	if (network_batch) {
+		ret_value = telephony_unset_noti_batch_cb(network_batch);
 		if (ret_value != TELEPHONY_ERROR_NONE)
-			LOGE("Unset noti failed!!!");
+			LOGE("Unset noti batch failed!!!");
 	}
 
 	ret_value = telephony_deinit(&handle_list);
 	if (ret_value != TELEPHONY_ERROR_NONE)
 		LOGE("Deinitialize failed!!!");
 
+	/* Notifications on the dispatcher thread */
+	ret_value = telephony_init_with_dispatcher(&handle_list);
+	if (ret_value != TELEPHONY_ERROR_NONE) {
+		LOGE("Initialize with dispatcher failed!!!");
+		return 0;
+	}
+
+	ret_value = telephony_set_noti_cb(handle_list.handle[0], TELEPHONY_NOTI_SIM_STATUS, sim_noti_cb, NULL);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("Set noti on dispatcher failed!!!");
+
+	ret_value = telephony_unset_noti_cb(handle_list.handle[0], TELEPHONY_NOTI_SIM_STATUS);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("Unset noti on dispatcher failed!!!");
+
+	/* Event queue, drained without any main loop in this thread */
+	ret_value = telephony_event_queue_create(handle_list.handle[0], call_noti_tbl,
+		sizeof(call_noti_tbl) / sizeof(telephony_noti_e), 64, &event_queue);
+	if (ret_value != TELEPHONY_ERROR_NONE) {
+		LOGE("telephony_event_queue_create() failed!!!");
+	} else {
+		struct pollfd pfd = { 0, POLLIN, 0 };
+
+		telephony_event_queue_get_fd(event_queue, &pfd.fd);
+		if (poll(&pfd, 1, 5000) > 0) {
+			ret_value = telephony_event_poll(event_queue, events,
+				sizeof(events) / sizeof(telephony_event_s), &event_count);
+			for (i = 0; ret_value == TELEPHONY_ERROR_NONE && i < event_count; i++)
+				LOGI("Event noti_id: [%d], timestamp: [%llu]", events[i].noti_id, events[i].timestamp);
+		}
+		telephony_event_queue_destroy(event_queue);
+	}
+
+	ret_value = telephony_deinit(&handle_list);
+	if (ret_value != TELEPHONY_ERROR_NONE)
+		LOGE("Deinitialize with dispatcher failed!!!");
+
 	return 0;
 }
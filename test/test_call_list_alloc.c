@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2014 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Checks that telephony_call_get_call_list() makes a single allocation
+ * whatever the number of calls, when it is served from the call table:
+ * every call handle must point into the block of the list, right after
+ * its handle array, which telephony_call_release_call_list() frees alone.
+ * The call table of a fake handle is filled directly, so neither the
+ * telephony daemon nor a modem is needed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+
+#include <telephony.h>
+#include "telephony_private.h"
+
+static int check_call_list(telephony_data *data, unsigned int call_count)
+{
+	telephony_call_h *call_list = NULL;
+	telephony_call_info_s call_info;
+	telephony_call_info_s *records;
+	unsigned int count = 0;
+	unsigned int id = 0;
+	unsigned int i;
+	int ret;
+
+	g_array_set_size(data->call_table.calls, 0);
+	for (i = 0; i < call_count; i++) {
+		memset(&call_info, 0, sizeof(call_info));
+		call_info.id = i + 1;
+		call_info.status = TELEPHONY_CALL_STATUS_ACTIVE;
+		g_array_append_vals(data->call_table.calls, &call_info, 1);
+	}
+
+	ret = telephony_call_get_call_list((telephony_h)data, &count, &call_list);
+	if (ret != TELEPHONY_ERROR_NONE || count != call_count) {
+		printf("FAIL: [%u] calls, ret [%d], count [%u]\n", call_count, ret, count);
+		return 1;
+	}
+
+	if (count == 0) {
+		if (call_list != NULL) {
+			printf("FAIL: no call, a list was allocated\n");
+			return 1;
+		}
+		printf("[0] calls: no allocation\n");
+		return 0;
+	}
+
+	/* The records follow the handle array in the same block */
+	records = (telephony_call_info_s *)(call_list + count);
+	for (i = 0; i < count; i++) {
+		if (call_list[i] != (telephony_call_h)&records[i]) {
+			printf("FAIL: [%u] calls, call [%u] is outside the list block\n", call_count, i);
+			return 1;
+		}
+		telephony_call_get_handle_id(call_list[i], &id);
+		if (id != i + 1) {
+			printf("FAIL: [%u] calls, call [%u] has id [%u]\n", call_count, i, id);
+			return 1;
+		}
+	}
+	telephony_call_release_call_list(count, &call_list);
+	if (call_list != NULL) {
+		printf("FAIL: [%u] calls, the list was not released\n", call_count);
+		return 1;
+	}
+
+	printf("[%u] calls: one block\n", call_count);
+
+	return 0;
+}
+
+int main(void)
+{
+	static const unsigned int call_counts[] = { 0, 1, 2, 7, 8, 9, 32, 100 };
+	struct tapi_handle tapi_h;
+	telephony_data *data = g_new0(telephony_data, 1);
+	int failed = 0;
+	unsigned int i;
+
+	/* A seeded call table, as kept up to date by the call signals */
+	memset(&tapi_h, 0, sizeof(tapi_h));
+	data->tapi_h = &tapi_h;
+	g_mutex_init(&data->call_table.mutex);
+	data->call_table.calls = g_array_new(FALSE, TRUE, sizeof(telephony_call_info_s));
+	data->call_table.valid = TRUE;
+
+	for (i = 0; i < sizeof(call_counts) / sizeof(call_counts[0]); i++)
+		failed |= check_call_list(data, call_counts[i]);
+
+	g_array_free(data->call_table.calls, TRUE);
+	g_mutex_clear(&data->call_table.mutex);
+	g_free(data);
+
+	printf("%s\n", failed ? "FAILED" : "PASSED");
+
+	return failed;
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2014 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Checks the pollable event queue: its descriptor must be readable exactly
+ * while events are pending, events must come out in order across many
+ * wraps of the ring, a full ring must keep its oldest events, and a thread
+ * blocked in poll() must be woken up by events dispatched on another one.
+ */
+
+#include <stdio.h>
+#include <poll.h>
+#include <glib.h>
+#include <TelNetwork.h>
+
+#include "test_fake_handle.h"
+
+#define CAPACITY 4
+#define WRAP_ROUNDS 10
+#define EVENTS_MAX 8
+
+static const telephony_noti_e cell_id_noti[] = { TELEPHONY_NOTI_NETWORK_CELLID };
+
+static int is_readable(telephony_event_queue_h queue, int timeout_ms)
+{
+	struct pollfd pfd;
+
+	telephony_event_queue_get_fd(queue, &pfd.fd);
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+
+	return poll(&pfd, 1, timeout_ms) == 1 && (pfd.revents & POLLIN);
+}
+
+/* Sends a cell ID change and lets the handle dispatch it */
+static void emit_cell_id(telephony_data *data, int cell_id)
+{
+	fake_tapi_emit_int(data, TAPI_PROP_NETWORK_CELLID, cell_id);
+	fake_drain();
+}
+
+/* Polls at most max events, which must carry the cell IDs from first on */
+static int poll_cell_ids(const char *step, telephony_event_queue_h queue,
+	unsigned int max, unsigned int expected, int first)
+{
+	telephony_event_s events[EVENTS_MAX];
+	unsigned int count = 0;
+	unsigned int i;
+
+	if (telephony_event_poll(queue, events, max, &count) != TELEPHONY_ERROR_NONE || count != expected) {
+		printf("FAIL: %s: [%u] events polled, expected [%u]\n", step, count, expected);
+		return 1;
+	}
+	for (i = 0; i < count; i++) {
+		if (events[i].noti_id != TELEPHONY_NOTI_NETWORK_CELLID || events[i].data.int_value != first + (int)i) {
+			printf("FAIL: %s: event [%u] is noti [%d] with [%d], expected cell ID [%d]\n", step, i,
+				events[i].noti_id, events[i].data.int_value, first + (int)i);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* The descriptor follows the pending events, which come out in order while the ring wraps */
+static int check_ring_wrap(void)
+{
+	telephony_data *data = fake_handle_new(FALSE);
+	telephony_event_queue_h queue = NULL;
+	int cell_id = 1;
+	int round;
+	int failed = 0;
+
+	telephony_event_queue_create((telephony_h)data, cell_id_noti, 1, CAPACITY, &queue);
+	if (is_readable(queue, 0)) {
+		printf("FAIL: wrap: readable while empty\n");
+		failed = 1;
+	}
+
+	for (round = 0; round < WRAP_ROUNDS && !failed; round++) {
+		emit_cell_id(data, cell_id);
+		emit_cell_id(data, cell_id + 1);
+		emit_cell_id(data, cell_id + 2);
+		if (!is_readable(queue, 0)) {
+			printf("FAIL: wrap: round [%d], not readable with events pending\n", round);
+			failed = 1;
+		}
+		failed |= poll_cell_ids("wrap", queue, 2, 2, cell_id);
+		if (!is_readable(queue, 0)) {
+			printf("FAIL: wrap: round [%d], not readable with an event left\n", round);
+			failed = 1;
+		}
+		failed |= poll_cell_ids("wrap", queue, EVENTS_MAX, 1, cell_id + 2);
+		if (is_readable(queue, 0)) {
+			printf("FAIL: wrap: round [%d], readable once drained\n", round);
+			failed = 1;
+		}
+		cell_id += 3;
+	}
+	if (!failed)
+		printf("wrap: [%d] events in order through a ring of [%d]\n", cell_id - 1, CAPACITY);
+
+	telephony_event_queue_destroy(queue);
+	fake_handle_free(data);
+
+	return failed;
+}
+
+/* A full ring keeps its oldest events, the later ones are dropped */
+static int check_full_ring(void)
+{
+	telephony_data *data = fake_handle_new(FALSE);
+	telephony_event_queue_h queue = NULL;
+	int cell_id;
+	int failed = 0;
+
+	telephony_event_queue_create((telephony_h)data, cell_id_noti, 1, CAPACITY, &queue);
+	for (cell_id = 1; cell_id <= CAPACITY + 2; cell_id++)
+		emit_cell_id(data, cell_id);
+
+	failed |= poll_cell_ids("full", queue, EVENTS_MAX, CAPACITY, 1);
+	if (is_readable(queue, 0)) {
+		printf("FAIL: full: readable once drained\n");
+		failed = 1;
+	}
+	if (!failed)
+		printf("full: the [%d] oldest events kept\n", CAPACITY);
+
+	telephony_event_queue_destroy(queue);
+	fake_handle_free(data);
+
+	return failed;
+}
+
+/* A consumer blocked in poll() is woken up by events dispatched on the dispatcher thread */
+static int check_wakeup(void)
+{
+	telephony_data *data = fake_handle_new(TRUE);
+	telephony_event_queue_h queue = NULL;
+	int cell_id = 1;
+	int failed = 0;
+
+	telephony_event_queue_create((telephony_h)data, cell_id_noti, 1, CAPACITY, &queue);
+	fake_tapi_post(data, TAPI_PROP_NETWORK_CELLID, &cell_id, sizeof(cell_id));
+
+	if (!is_readable(queue, 1000)) {
+		printf("FAIL: wakeup: no wakeup within a second\n");
+		failed = 1;
+	} else {
+		failed |= poll_cell_ids("wakeup", queue, EVENTS_MAX, 1, 1);
+	}
+	if (!failed)
+		printf("wakeup: woken up from another thread\n");
+
+	telephony_event_queue_destroy(queue);
+	fake_handle_free(data);
+
+	return failed;
+}
+
+int main(void)
+{
+	int failed = 0;
+
+	failed |= check_ring_wrap();
+	failed |= check_full_ring();
+	failed |= check_wakeup();
+
+	printf("%s\n", failed ? "FAILED" : "PASSED");
+
+	return failed;
+}
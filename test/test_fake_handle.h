@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2014 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __TIZEN_TELEPHONY_TEST_FAKE_HANDLE_H__
+#define __TIZEN_TELEPHONY_TEST_FAKE_HANDLE_H__
+
+/*
+ * Fake handles for the test programs, included once by a test program.
+ *
+ * The TAPI notification registration is replaced: the library calls the
+ * functions below instead of libtapi's, and the tests send TAPI events to
+ * the registered callbacks with fake_tapi_emit() or fake_tapi_post().
+ * Neither the telephony daemon nor a modem is needed.
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <tapi_common.h>
+#include <TapiUtility.h>
+#include <TelCall.h>
+
+#include <telephony.h>
+#include "telephony_private.h"
+
+/* A notification registered with tel_register_noti_event() */
+typedef struct {
+	TapiHandle *tapi_h;
+	char *evt_id;
+	tapi_notification_cb callback;
+	void *user_data;
+	GMainContext *context;
+} fake_tapi_noti;
+
+/* A TAPI event on its way to its callback */
+typedef struct {
+	TapiHandle *tapi_h;
+	char *evt_id;
+	void *data;
+} fake_tapi_event;
+
+static GMutex fake_tapi_mutex;
+static GSList *fake_tapi_notis;
+
+/* Must be called with fake_tapi_mutex held */
+static fake_tapi_noti *fake_tapi_noti_find(TapiHandle *tapi_h, const char *evt_id)
+{
+	GSList *list;
+
+	for (list = fake_tapi_notis; list; list = list->next) {
+		fake_tapi_noti *noti = list->data;
+
+		if (noti->tapi_h == tapi_h && !g_strcmp0(noti->evt_id, evt_id))
+			return noti;
+	}
+
+	return NULL;
+}
+
+int tel_register_noti_event(TapiHandle *handle, const char *noti_id,
+	tapi_notification_cb callback, void *user_data)
+{
+	fake_tapi_noti *noti = g_new0(fake_tapi_noti, 1);
+
+	noti->tapi_h = handle;
+	noti->evt_id = g_strdup(noti_id);
+	noti->callback = callback;
+	noti->user_data = user_data;
+	noti->context = g_main_context_ref_thread_default();
+	g_mutex_lock(&fake_tapi_mutex);
+	fake_tapi_notis = g_slist_prepend(fake_tapi_notis, noti);
+	g_mutex_unlock(&fake_tapi_mutex);
+
+	return TAPI_API_SUCCESS;
+}
+
+int tel_deregister_noti_event(TapiHandle *handle, const char *noti_id)
+{
+	fake_tapi_noti *noti;
+
+	g_mutex_lock(&fake_tapi_mutex);
+	noti = fake_tapi_noti_find(handle, noti_id);
+	if (noti)
+		fake_tapi_notis = g_slist_remove(fake_tapi_notis, noti);
+	g_mutex_unlock(&fake_tapi_mutex);
+
+	if (noti) {
+		g_main_context_unref(noti->context);
+		g_free(noti->evt_id);
+		g_free(noti);
+	}
+
+	return TAPI_API_SUCCESS;
+}
+
+static void fake_tapi_event_free(gpointer user_data)
+{
+	fake_tapi_event *event = user_data;
+
+	g_free(event->evt_id);
+	g_free(event->data);
+	g_free(event);
+}
+
+static gboolean fake_tapi_event_cb(gpointer user_data)
+{
+	fake_tapi_event *event = user_data;
+	tapi_notification_cb callback = NULL;
+	void *noti_user_data = NULL;
+	fake_tapi_noti *noti;
+
+	/* Looked up again, the event may have been deregistered meanwhile */
+	g_mutex_lock(&fake_tapi_mutex);
+	noti = fake_tapi_noti_find(event->tapi_h, event->evt_id);
+	if (noti) {
+		callback = noti->callback;
+		noti_user_data = noti->user_data;
+	}
+	g_mutex_unlock(&fake_tapi_mutex);
+
+	if (callback)
+		callback(event->tapi_h, event->evt_id, event->data, noti_user_data);
+
+	return FALSE;
+}
+
+/*
+ * Invokes the callback registered for evt_id with event_data right away,
+ * as the signal dispatch of GDBus does on the main context of the handle.
+ * Returns FALSE when nobody registered it.
+ */
+static inline gboolean fake_tapi_emit(telephony_data *data, const char *evt_id, void *event_data)
+{
+	tapi_notification_cb callback = NULL;
+	void *noti_user_data = NULL;
+	fake_tapi_noti *noti;
+
+	g_mutex_lock(&fake_tapi_mutex);
+	noti = fake_tapi_noti_find(data->tapi_h, evt_id);
+	if (noti) {
+		callback = noti->callback;
+		noti_user_data = noti->user_data;
+	}
+	g_mutex_unlock(&fake_tapi_mutex);
+	if (callback == NULL)
+		return FALSE;
+
+	callback(data->tapi_h, evt_id, event_data, noti_user_data);
+
+	return TRUE;
+}
+
+/*
+ * Sends a copy of the size bytes of event_data to the callback registered
+ * for evt_id from any thread, it is invoked from the main context the
+ * event was registered on. Returns FALSE when nobody registered it.
+ */
+static inline gboolean fake_tapi_post(telephony_data *data, const char *evt_id,
+	const void *event_data, gsize size)
+{
+	fake_tapi_event *event;
+	fake_tapi_noti *noti;
+	GMainContext *context = NULL;
+	GSource *source;
+
+	g_mutex_lock(&fake_tapi_mutex);
+	noti = fake_tapi_noti_find(data->tapi_h, evt_id);
+	if (noti)
+		context = g_main_context_ref(noti->context);
+	g_mutex_unlock(&fake_tapi_mutex);
+	if (context == NULL)
+		return FALSE;
+
+	event = g_new(fake_tapi_event, 1);
+	event->tapi_h = data->tapi_h;
+	event->evt_id = g_strdup(evt_id);
+	event->data = g_malloc(size);
+	memcpy(event->data, event_data, size);
+	source = g_idle_source_new();
+	g_source_set_priority(source, G_PRIORITY_DEFAULT);
+	g_source_set_callback(source, fake_tapi_event_cb, event, fake_tapi_event_free);
+	g_source_attach(source, context);
+	g_source_unref(source);
+	g_main_context_unref(context);
+
+	return TRUE;
+}
+
+/* Sends an integer property change, as TAPI reports them */
+static inline gboolean fake_tapi_emit_int(telephony_data *data, const char *evt_id, int value)
+{
+	return fake_tapi_emit(data, evt_id, &value);
+}
+
+/* Sends a call status change of the call id */
+static inline gboolean fake_tapi_emit_call(telephony_data *data, const char *evt_id, unsigned int id)
+{
+	TelCallIncomingCallInfo_t incoming;
+	TelCallStatusIdleNoti_t status;
+
+	if (!g_strcmp0(evt_id, TAPI_NOTI_VOICE_CALL_STATUS_INCOMING)
+			|| !g_strcmp0(evt_id, TAPI_NOTI_VIDEO_CALL_STATUS_INCOMING)) {
+		memset(&incoming, 0, sizeof(incoming));
+		incoming.CallHandle = id;
+		return fake_tapi_emit(data, evt_id, &incoming);
+	}
+
+	/* The status structures of the other calls all start with the call id */
+	memset(&status, 0, sizeof(status));
+	status.id = id;
+
+	return fake_tapi_emit(data, evt_id, &status);
+}
+
+/* A handle fed by fake_tapi_emit() and fake_tapi_post(), dispatching on its own thread or on the default main context */
+static inline telephony_data *fake_handle_new(gboolean with_dispatcher)
+{
+	telephony_data *data = g_new0(telephony_data, 1);
+
+	data->tapi_h = g_malloc0(sizeof(struct tapi_handle));
+	if (with_dispatcher) {
+		data->dispatcher = _telephony_dispatcher_new();
+		data->context = g_main_context_ref(_telephony_dispatcher_get_context(data->dispatcher));
+	} else {
+		data->context = g_main_context_ref_thread_default();
+	}
+	/* An empty call table without its D-Bus subscription, call events come through TAPI */
+	g_mutex_init(&data->call_table.mutex);
+	data->call_table.calls = g_array_new(FALSE, TRUE, sizeof(telephony_call_info_s));
+	_telephony_noti_registry_init(data);
+
+	return data;
+}
+
+static int fake_handle_teardown(telephony_data *data, gpointer user_data)
+{
+	_telephony_noti_replay_cancel(data);
+	_telephony_noti_registry_deinit(data);
+
+	return TELEPHONY_ERROR_NONE;
+}
+
+static inline void fake_handle_free(telephony_data *data)
+{
+	_telephony_dispatcher_call(data, fake_handle_teardown, NULL);
+	if (data->dispatcher)
+		_telephony_dispatcher_unref(data->dispatcher);
+	g_array_free(data->call_table.calls, TRUE);
+	g_mutex_clear(&data->call_table.mutex);
+	g_main_context_unref(data->context);
+	g_free(data->tapi_h);
+	g_free(data);
+}
+
+/* Runs the default main context until *count reaches target, for a second at most */
+static inline gboolean fake_wait_count(gint *count, gint target)
+{
+	gint64 end = g_get_monotonic_time() + G_USEC_PER_SEC;
+
+	while (g_atomic_int_get(count) < target && g_get_monotonic_time() < end) {
+		if (!g_main_context_iteration(NULL, FALSE))
+			g_usleep(1000);
+	}
+
+	return g_atomic_int_get(count) >= target;
+}
+
+/* Runs everything pending on the default main context */
+static inline void fake_drain(void)
+{
+	while (g_main_context_iteration(NULL, FALSE))
+		;
+}
+
+#endif /* __TIZEN_TELEPHONY_TEST_FAKE_HANDLE_H__ */
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2014 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Checks the time lookups of the network history: before its first change,
+ * exactly at a change, just before one, after the last one, and once the
+ * ring has wrapped so that the oldest changes were folded into its base.
+ * The cell IDs are fed by the network cache of a fake handle, which reads
+ * them from the fake TAPI property below.
+ */
+
+#include <stdio.h>
+#include <limits.h>
+#include <string.h>
+#include <glib.h>
+#include <tapi_common.h>
+#include <TapiUtility.h>
+#include <TelNetwork.h>
+
+#include <telephony.h>
+#include "telephony_private.h"
+
+#define CAPACITY 4
+#define CHANGES 7
+#define FIRST_CELL_ID 100
+
+static int fake_cell_id;
+
+int tel_get_property_int(TapiHandle *handle, const char *property, int *result)
+{
+	if (g_strcmp0(property, TAPI_PROP_NETWORK_CELLID))
+		return TAPI_API_OPERATION_FAILED;
+	*result = fake_cell_id;
+
+	return TAPI_API_SUCCESS;
+}
+
+typedef struct {
+	unsigned long long timestamps[CHANGES];
+	int cell_ids[CHANGES];
+	unsigned int count;
+} history_changes;
+
+static bool collect_cb(unsigned long long timestamp, const telephony_network_snapshot_s *snapshot,
+	void *user_data)
+{
+	history_changes *changes = user_data;
+
+	if (changes->count < CHANGES) {
+		changes->timestamps[changes->count] = timestamp;
+		changes->cell_ids[changes->count] = snapshot->cell_id;
+		changes->count++;
+	}
+
+	return true;
+}
+
+/* The cell changes and the application reads it, which updates the cache and its history */
+static void change_cell_id(telephony_data *data, int cell_id)
+{
+	int value = 0;
+
+	/* Distinct timestamps for every change */
+	g_usleep(1000);
+	fake_cell_id = cell_id;
+	_telephony_network_cache_invalidate(data);
+	telephony_network_get_cell_id((telephony_h)data, &value);
+}
+
+static int check_cell_id_at(const char *step, telephony_data *data,
+	unsigned long long timestamp, int expected)
+{
+	telephony_network_snapshot_s snapshot;
+	int ret;
+
+	ret = telephony_network_history_at((telephony_h)data, timestamp, &snapshot);
+	if (ret != TELEPHONY_ERROR_NONE || snapshot.cell_id != expected) {
+		printf("FAIL: %s: ret [%d], cell ID [%d], expected [%d]\n", step, ret, snapshot.cell_id, expected);
+		return 1;
+	}
+	printf("%s: cell ID [%d]\n", step, snapshot.cell_id);
+
+	return 0;
+}
+
+static int check_history(telephony_data *data, unsigned long long enabled)
+{
+	history_changes changes;
+	telephony_network_snapshot_s snapshot;
+	unsigned long long before_first, from, to;
+	unsigned int i;
+	int failed = 0;
+
+	memset(&changes, 0, sizeof(changes));
+	telephony_network_history_foreach((telephony_h)data, 0, ULLONG_MAX, collect_cb, &changes);
+	if (changes.count != CAPACITY) {
+		printf("FAIL: [%u] changes kept, expected [%d]\n", changes.count, CAPACITY);
+		return 1;
+	}
+	for (i = 0; i < changes.count; i++) {
+		if (changes.cell_ids[i] != FIRST_CELL_ID + CHANGES - CAPACITY + (int)i
+				|| (i > 0 && changes.timestamps[i] <= changes.timestamps[i - 1])) {
+			printf("FAIL: change [%u] is cell ID [%d] at [%llu]\n", i,
+				changes.cell_ids[i], changes.timestamps[i]);
+			return 1;
+		}
+	}
+
+	/* Before the history began */
+	if (telephony_network_history_at((telephony_h)data, enabled - 1, &snapshot) != TELEPHONY_ERROR_INVALID_PARAMETER) {
+		printf("FAIL: a state before the history began\n");
+		failed = 1;
+	}
+
+	/* Before the first change kept, the state of the changes folded into the base */
+	before_first = changes.timestamps[0] - 1;
+	failed |= check_cell_id_at("before the first change", data, before_first,
+		FIRST_CELL_ID + CHANGES - CAPACITY - 1);
+
+	for (i = 0; i < changes.count; i++) {
+		failed |= check_cell_id_at("exactly at a change", data, changes.timestamps[i], changes.cell_ids[i]);
+		if (i > 0)
+			failed |= check_cell_id_at("just before a change", data, changes.timestamps[i] - 1,
+				changes.cell_ids[i - 1]);
+	}
+
+	failed |= check_cell_id_at("after the last change", data, ULLONG_MAX, FIRST_CELL_ID + CHANGES - 1);
+
+	/* A range bounded by two changes includes both */
+	from = changes.timestamps[1];
+	to = changes.timestamps[2];
+	changes.count = 0;
+	telephony_network_history_foreach((telephony_h)data, from, to, collect_cb, &changes);
+	if (changes.count != 2 || changes.timestamps[0] != from || changes.timestamps[1] != to) {
+		printf("FAIL: [%u] changes between two changes, expected [2]\n", changes.count);
+		failed = 1;
+	}
+
+	return failed;
+}
+
+int main(void)
+{
+	struct tapi_handle tapi_h;
+	telephony_data *data = g_new0(telephony_data, 1);
+	unsigned long long enabled;
+	int failed = 0;
+	int i;
+
+	/* A network cache whose properties changed signal is taken as subscribed */
+	memset(&tapi_h, 0, sizeof(tapi_h));
+	data->tapi_h = &tapi_h;
+	g_mutex_init(&data->network_cache.mutex);
+	data->network_cache.prop_changed_id = 1;
+
+	enabled = g_get_monotonic_time();
+	if (telephony_network_history_enable((telephony_h)data, CAPACITY) != TELEPHONY_ERROR_NONE) {
+		printf("FAIL: telephony_network_history_enable() failed\n");
+		return 1;
+	}
+
+	/* More changes than the ring holds, the oldest ones are folded into its base */
+	for (i = 0; i < CHANGES; i++)
+		change_cell_id(data, FIRST_CELL_ID + i);
+	failed |= check_history(data, enabled);
+
+	telephony_network_history_disable((telephony_h)data);
+	_telephony_network_cache_invalidate(data);
+	g_mutex_clear(&data->network_cache.mutex);
+	g_free(data);
+
+	printf("%s\n", failed ? "FAILED" : "PASSED");
+
+	return failed;
+}
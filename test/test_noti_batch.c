@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2014 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Checks the batched delivery of notifications: a burst must reach the
+ * batch callback once, in order, when the main loop is idle or when the
+ * window opened by its first notification ends, and on the thread which
+ * dispatches the handle.
+ */
+
+#include <stdio.h>
+#include <glib.h>
+#include <TelNetwork.h>
+
+#include "test_fake_handle.h"
+
+#define WINDOW_MS 100
+#define BATCHES_MAX 4
+
+static const struct {
+	const char *evt_id;
+	telephony_noti_e noti_id;
+	int value;
+} burst[] = {
+	{ TAPI_PROP_NETWORK_ROAMING_STATUS, TELEPHONY_NOTI_NETWORK_ROAMING_STATUS, 0 },
+	{ TAPI_PROP_NETWORK_CELLID, TELEPHONY_NOTI_NETWORK_CELLID, 100 },
+	{ TAPI_PROP_NETWORK_PS_TYPE, TELEPHONY_NOTI_NETWORK_PS_TYPE, 1 },
+	{ TAPI_PROP_NETWORK_SIGNALSTRENGTH_LEVEL, TELEPHONY_NOTI_NETWORK_SIGNALSTRENGTH_LEVEL, 3 },
+};
+
+#define BURST_LEN (sizeof(burst) / sizeof(burst[0]))
+
+static const telephony_noti_e burst_noti_ids[] = {
+	TELEPHONY_NOTI_NETWORK_ROAMING_STATUS,
+	TELEPHONY_NOTI_NETWORK_CELLID,
+	TELEPHONY_NOTI_NETWORK_PS_TYPE,
+	TELEPHONY_NOTI_NETWORK_SIGNALSTRENGTH_LEVEL,
+};
+
+static struct {
+	telephony_event_s events[BURST_LEN];
+	size_t count;
+	gint64 time;
+	GThread *thread;
+} batches[BATCHES_MAX];
+static gint batch_count;
+
+static void batch_cb(telephony_h handle, const telephony_event_s *events, size_t count, void *user_data)
+{
+	gint index = g_atomic_int_get(&batch_count);
+
+	if (index >= BATCHES_MAX)
+		return;
+	batches[index].count = MIN(count, BURST_LEN);
+	memcpy(batches[index].events, events, batches[index].count * sizeof(events[0]));
+	batches[index].time = g_get_monotonic_time();
+	batches[index].thread = g_thread_self();
+	g_atomic_int_inc(&batch_count);
+}
+
+/* The batch index holds the whole burst sent with offset, in order */
+static int check_batch(const char *step, gint index, int offset)
+{
+	unsigned int i;
+
+	if (g_atomic_int_get(&batch_count) <= index || batches[index].count != BURST_LEN) {
+		printf("FAIL: %s: batch [%d] missing or incomplete\n", step, index);
+		return 1;
+	}
+	for (i = 0; i < BURST_LEN; i++) {
+		if (batches[index].events[i].noti_id != burst[i].noti_id
+				|| batches[index].events[i].data.int_value != burst[i].value + offset) {
+			printf("FAIL: %s: event [%u] is noti [%d] with [%d]\n", step, i,
+				batches[index].events[i].noti_id, batches[index].events[i].data.int_value);
+			return 1;
+		}
+	}
+	printf("%s: [%u] events in one batch\n", step, (unsigned int)BURST_LEN);
+
+	return 0;
+}
+
+static void emit_burst(telephony_data *data, int offset)
+{
+	unsigned int i;
+
+	for (i = 0; i < BURST_LEN; i++)
+		fake_tapi_emit_int(data, burst[i].evt_id, burst[i].value + offset);
+}
+
+/* Without a window, the burst is delivered once the main loop is idle */
+static int check_idle_batch(void)
+{
+	telephony_data *data = fake_handle_new(FALSE);
+	telephony_noti_batch_h batch = NULL;
+	int failed = 0;
+
+	g_atomic_int_set(&batch_count, 0);
+	telephony_set_noti_batch_cb((telephony_h)data, burst_noti_ids, BURST_LEN, 0, batch_cb, NULL, &batch);
+
+	emit_burst(data, 0);
+	fake_drain();
+	failed |= check_batch("idle", 0, 0);
+	if (g_atomic_int_get(&batch_count) != 1) {
+		printf("FAIL: idle: [%d] batches, expected [1]\n", g_atomic_int_get(&batch_count));
+		failed = 1;
+	}
+
+	telephony_unset_noti_batch_cb(batch);
+	fake_handle_free(data);
+
+	return failed;
+}
+
+/* With a window, notifications spread over it are delivered together when it ends */
+static int check_window_batch(void)
+{
+	telephony_data *data = fake_handle_new(FALSE);
+	telephony_noti_batch_h batch = NULL;
+	gint64 start;
+	unsigned int i;
+	int failed = 0;
+
+	g_atomic_int_set(&batch_count, 0);
+	telephony_set_noti_batch_cb((telephony_h)data, burst_noti_ids, BURST_LEN, WINDOW_MS, batch_cb, NULL, &batch);
+
+	start = g_get_monotonic_time();
+	for (i = 0; i < BURST_LEN; i++) {
+		fake_tapi_emit_int(data, burst[i].evt_id, burst[i].value);
+		fake_drain();
+		g_usleep(WINDOW_MS * 1000 / (BURST_LEN * 2));
+	}
+	if (g_atomic_int_get(&batch_count) != 0) {
+		printf("FAIL: window: delivered before the window ended\n");
+		failed = 1;
+	}
+
+	fake_wait_count(&batch_count, 1);
+	failed |= check_batch("window", 0, 0);
+	if (g_atomic_int_get(&batch_count) == 1 && batches[0].time - start < WINDOW_MS * 1000) {
+		printf("FAIL: window: delivered [%lld] us after the first event\n",
+			(long long)(batches[0].time - start));
+		failed = 1;
+	}
+
+	/* The next notification opens a new window, with new values not to be filtered */
+	emit_burst(data, 1);
+	fake_wait_count(&batch_count, 2);
+	failed |= check_batch("next window", 1, 1);
+
+	telephony_unset_noti_batch_cb(batch);
+	fake_handle_free(data);
+
+	return failed;
+}
+
+/* With a dispatcher, the batch is delivered by its thread while the main loop does not run */
+static int check_dispatcher_batch(void)
+{
+	telephony_data *data = fake_handle_new(TRUE);
+	telephony_noti_batch_h batch = NULL;
+	gint64 end;
+	unsigned int i;
+	int failed = 0;
+
+	g_atomic_int_set(&batch_count, 0);
+	telephony_set_noti_batch_cb((telephony_h)data, burst_noti_ids, BURST_LEN, WINDOW_MS, batch_cb, NULL, &batch);
+
+	for (i = 0; i < BURST_LEN; i++)
+		fake_tapi_post(data, burst[i].evt_id, &burst[i].value, sizeof(burst[i].value));
+
+	end = g_get_monotonic_time() + G_USEC_PER_SEC;
+	while (g_atomic_int_get(&batch_count) < 1 && g_get_monotonic_time() < end)
+		g_usleep(1000);
+	failed |= check_batch("dispatcher", 0, 0);
+	if (g_atomic_int_get(&batch_count) == 1 && batches[0].thread == g_thread_self()) {
+		printf("FAIL: dispatcher: delivered on the main thread\n");
+		failed = 1;
+	}
+
+	telephony_unset_noti_batch_cb(batch);
+	fake_handle_free(data);
+
+	return failed;
+}
+
+int main(void)
+{
+	int failed = 0;
+
+	failed |= check_idle_batch();
+	failed |= check_window_batch();
+	failed |= check_dispatcher_batch();
+
+	printf("%s\n", failed ? "FAILED" : "PASSED");
+
+	return failed;
+}
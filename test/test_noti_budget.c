@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2014 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Checks the callback budget: a callback running longer than the budget of
+ * its handle must be reported once per notification ID with the number of
+ * overruns and the longest one, while a fast callback of the same
+ * notification is not reported.
+ */
+
+#include <stdio.h>
+#include <glib.h>
+#include <TelNetwork.h>
+
+#include "test_fake_handle.h"
+
+#define BUDGET_US 1000
+#define SLOW_US 3000
+#define NOTIFICATIONS 3
+
+static gint delivered;
+
+static void fast_cb(telephony_h handle, telephony_noti_e noti_id, void *data, void *user_data)
+{
+	g_atomic_int_inc(&delivered);
+}
+
+static void slow_cb(telephony_h handle, telephony_noti_e noti_id, void *data, void *user_data)
+{
+	g_usleep(SLOW_US);
+}
+
+int main(void)
+{
+	telephony_data *data = fake_handle_new(FALSE);
+	telephony_noti_slow_callback_s slow[TELEPHONY_NOTI_SLOW_CALLBACKS_MAX];
+	telephony_noti_stats_s stats;
+	unsigned int count = 0;
+	int failed = 0;
+	int i;
+
+	if (telephony_set_noti_callback_budget((telephony_h)data, 0) != TELEPHONY_ERROR_INVALID_PARAMETER) {
+		printf("FAIL: a budget of 0 accepted\n");
+		failed = 1;
+	}
+	telephony_set_noti_callback_budget((telephony_h)data, BUDGET_US);
+	telephony_set_noti_cb((telephony_h)data, TELEPHONY_NOTI_NETWORK_CELLID, fast_cb, NULL);
+	telephony_set_noti_cb((telephony_h)data, TELEPHONY_NOTI_NETWORK_CELLID, slow_cb, NULL);
+
+	for (i = 0; i < NOTIFICATIONS; i++) {
+		fake_tapi_emit_int(data, TAPI_PROP_NETWORK_CELLID, 100 + i);
+		fake_drain();
+	}
+	if (g_atomic_int_get(&delivered) != NOTIFICATIONS) {
+		printf("FAIL: [%d] notifications delivered, expected [%d]\n", g_atomic_int_get(&delivered), NOTIFICATIONS);
+		failed = 1;
+	}
+
+	telephony_get_noti_slow_callbacks((telephony_h)data, slow, TELEPHONY_NOTI_SLOW_CALLBACKS_MAX, &count);
+	if (count != 1 || slow[0].cb != slow_cb || slow[0].noti_id != TELEPHONY_NOTI_NETWORK_CELLID
+			|| slow[0].count != NOTIFICATIONS || slow[0].max_duration_us < SLOW_US) {
+		printf("FAIL: [%u] slow callbacks, the first one slow [%u] times for [%u] us at most\n",
+			count, count ? slow[0].count : 0, count ? slow[0].max_duration_us : 0);
+		failed = 1;
+	} else {
+		printf("slow callback: [%u] overruns, [%u] us at most\n", slow[0].count, slow[0].max_duration_us);
+	}
+
+	telephony_get_noti_stats((telephony_h)data, TELEPHONY_NOTI_NETWORK_CELLID, &stats);
+	if (stats.slow != NOTIFICATIONS) {
+		printf("FAIL: [%u] slow invocations counted, expected [%d]\n", stats.slow, NOTIFICATIONS);
+		failed = 1;
+	}
+
+	fake_handle_free(data);
+
+	printf("%s\n", failed ? "FAILED" : "PASSED");
+
+	return failed;
+}
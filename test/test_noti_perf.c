@@ -0,0 +1,420 @@
+/*
+ * Copyright (c) 2014 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Times the in-process paths of the library and prints the results.
+ * Nothing is checked, and neither the telephony daemon nor a modem is
+ * needed: the paths are run on fake handles.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <system_info.h>
+#include <TelCall.h>
+#include <TelNetwork.h>
+#include <TelSim.h>
+
+#include "test_fake_handle.h"
+
+#define ITERATIONS 1000000
+#define DISPATCH_ITERATIONS 100000
+#define DISPATCH_CALLS 4
+#define ROUND_TRIP_ITERATIONS 10000
+#define LATENCY_EVENTS 200
+#define BUSY_UI_WORK_US 5000
+#define NETWORK_CB_WORK_US 200
+#define FLOOD_INTERVAL_US 100
+#define RECORDER_SIZE (1024 * 1024)
+#define REPLAY_RECORDS 10000
+
+static void noop_cb(telephony_h handle, telephony_noti_e noti_id, void *data, void *user_data)
+{
+}
+
+static void print_mean(const char *name, gint64 elapsed, unsigned int iterations)
+{
+	printf("%-48s %10.1f ns\n", name, elapsed * 1000.0 / iterations);
+}
+
+static int compare_samples(const void *a, const void *b)
+{
+	gint64 sample_a = *(const gint64 *)a;
+	gint64 sample_b = *(const gint64 *)b;
+
+	return sample_a < sample_b ? -1 : sample_a > sample_b;
+}
+
+/* Sorts samples, in microseconds, and prints their distribution */
+static void print_percentiles(const char *name, gint64 *samples, unsigned int count)
+{
+	gint64 sum = 0;
+	unsigned int i;
+
+	if (count == 0) {
+		printf("%-48s no sample\n", name);
+		return;
+	}
+
+	qsort(samples, count, sizeof(samples[0]), compare_samples);
+	for (i = 0; i < count; i++)
+		sum += samples[i];
+	printf("%-48s mean %8.1f us, p50 %6lld us, p99 %6lld us, max %6lld us\n", name,
+		(double)sum / count, (long long)samples[count / 2],
+		(long long)samples[(count * 99) / 100], (long long)samples[count - 1]);
+}
+
+/* Cost of the feature check which starts every API, against asking System Info each time */
+static void perf_feature_check(void)
+{
+	telephony_call_info_s call_info;
+	telephony_call_status_e status;
+	bool supported = false;
+	gint64 start;
+	unsigned int i;
+
+	printf("Feature check, mean time per call:\n");
+
+	start = g_get_monotonic_time();
+	for (i = 0; i < ITERATIONS; i++)
+		system_info_get_platform_bool(TELEPHONY_FEATURE, &supported);
+	print_mean("system_info_get_platform_bool()", g_get_monotonic_time() - start, ITERATIONS);
+
+	memset(&call_info, 0, sizeof(call_info));
+	start = g_get_monotonic_time();
+	for (i = 0; i < ITERATIONS; i++)
+		telephony_call_get_status((telephony_call_h)&call_info, &status);
+	print_mean("telephony_call_get_status(), cached check", g_get_monotonic_time() - start, ITERATIONS);
+}
+
+/* Events of each payload type and lane, with the most frequent ones */
+static const struct {
+	const char *evt_id;
+	telephony_noti_e noti_id;
+	telephony_evt_payload_type_e type;
+} dispatch_events[] = {
+	{ TAPI_PROP_NETWORK_SIGNALSTRENGTH_LEVEL, TELEPHONY_NOTI_NETWORK_SIGNALSTRENGTH_LEVEL, EVT_PAYLOAD_INT },
+	{ TAPI_PROP_NETWORK_CELLID, TELEPHONY_NOTI_NETWORK_CELLID, EVT_PAYLOAD_INT },
+	{ TAPI_PROP_NETWORK_NETWORK_NAME, TELEPHONY_NOTI_NETWORK_NETWORK_NAME, EVT_PAYLOAD_STRING },
+	{ TAPI_NOTI_SIM_STATUS, TELEPHONY_NOTI_SIM_STATUS, EVT_PAYLOAD_INT },
+	{ TAPI_NOTI_VOICE_CALL_STATUS_INCOMING, TELEPHONY_NOTI_VOICE_CALL_STATUS_INCOMING, EVT_PAYLOAD_HANDLE_ID },
+	{ TAPI_NOTI_VOICE_CALL_STATUS_IDLE, TELEPHONY_NOTI_VOICE_CALL_STATUS_IDLE, EVT_PAYLOAD_HANDLE_ID },
+};
+
+/* Sends the TAPI event of dispatch_events[e], with a value differing from the previous one */
+static void emit_dispatch_event(telephony_data *data, unsigned int e, unsigned int i)
+{
+	TelSimCardStatus_t sim_status;
+	char string[16];
+
+	if (dispatch_events[e].type == EVT_PAYLOAD_HANDLE_ID) {
+		/* A few calls, so that the call table stays small */
+		fake_tapi_emit_call(data, dispatch_events[e].evt_id, i % DISPATCH_CALLS + 1);
+	} else if (dispatch_events[e].type == EVT_PAYLOAD_STRING) {
+		g_snprintf(string, sizeof(string), "%u", i);
+		fake_tapi_emit(data, dispatch_events[e].evt_id, string);
+	} else if (!g_strcmp0(dispatch_events[e].evt_id, TAPI_NOTI_SIM_STATUS)) {
+		sim_status = i % 2 ? TAPI_SIM_STATUS_CARD_NOT_PRESENT : TAPI_SIM_STATUS_SIM_INIT_COMPLETED;
+		fake_tapi_emit(data, dispatch_events[e].evt_id, &sim_status);
+	} else {
+		fake_tapi_emit_int(data, dispatch_events[e].evt_id, i);
+	}
+}
+
+/*
+ * Cost of dispatching one event of each type: decoding, lookup of its
+ * handler, lane, value filter and delivery to a subscriber
+ */
+static void perf_dispatch(void)
+{
+	telephony_data *data = fake_handle_new(FALSE);
+	gint64 start;
+	unsigned int e, i;
+
+	printf("Dispatch, mean time per event:\n");
+
+	for (e = 0; e < sizeof(dispatch_events) / sizeof(dispatch_events[0]); e++) {
+		telephony_set_noti_cb((telephony_h)data, dispatch_events[e].noti_id, noop_cb, NULL);
+
+		start = g_get_monotonic_time();
+		for (i = 0; i < DISPATCH_ITERATIONS; i++) {
+			/* A new value each time, so that the value filter lets it through */
+			emit_dispatch_event(data, e, i);
+			fake_drain();
+		}
+		print_mean(dispatch_events[e].evt_id, g_get_monotonic_time() - start, DISPATCH_ITERATIONS);
+		telephony_unset_noti_cb((telephony_h)data, dispatch_events[e].noti_id);
+	}
+
+	fake_handle_free(data);
+}
+
+static int noop_dispatch(telephony_data *data, gpointer user_data)
+{
+	return TELEPHONY_ERROR_NONE;
+}
+
+/* Cost of running a function on the dispatcher thread and waiting for it */
+static void perf_dispatcher_round_trip(void)
+{
+	telephony_data *data = fake_handle_new(TRUE);
+	gint64 start;
+	unsigned int i;
+
+	printf("Dispatcher, mean time per call:\n");
+
+	start = g_get_monotonic_time();
+	for (i = 0; i < ROUND_TRIP_ITERATIONS; i++)
+		_telephony_dispatcher_call(data, noop_dispatch, NULL);
+	print_mean("_telephony_dispatcher_call() round trip", g_get_monotonic_time() - start,
+		ROUND_TRIP_ITERATIONS);
+
+	fake_handle_free(data);
+}
+
+static gint64 emit_times[LATENCY_EVENTS];
+static gint64 latency_samples[LATENCY_EVENTS];
+static gint latency_count;
+
+/* Time from the emission of the incoming call, whose id is its index plus one, to its callback */
+static void latency_cb(telephony_h handle, telephony_noti_e noti_id, void *data, void *user_data)
+{
+	unsigned int call_id = *(unsigned int *)data;
+	gint index = g_atomic_int_get(&latency_count);
+
+	if (index >= LATENCY_EVENTS || call_id == 0 || call_id > LATENCY_EVENTS)
+		return;
+	latency_samples[index] = g_get_monotonic_time() - emit_times[call_id - 1];
+	g_atomic_int_inc(&latency_count);
+}
+
+/* Feeds incoming calls at irregular intervals, as the D-Bus thread of GDBus would */
+static gpointer incoming_call_feeder(gpointer user_data)
+{
+	telephony_data *data = user_data;
+	TelCallIncomingCallInfo_t incoming;
+	unsigned int i;
+
+	memset(&incoming, 0, sizeof(incoming));
+	for (i = 0; i < LATENCY_EVENTS; i++) {
+		g_usleep(2000 + (i * 7919) % 3000);
+		incoming.CallHandle = i + 1;
+		emit_times[i] = g_get_monotonic_time();
+		fake_tapi_post(data, TAPI_NOTI_VOICE_CALL_STATUS_INCOMING, &incoming, sizeof(incoming));
+	}
+
+	return NULL;
+}
+
+/* A main loop handler keeping the application busy, as UI rendering does */
+static gboolean busy_ui_cb(gpointer user_data)
+{
+	gint64 end = g_get_monotonic_time() + BUSY_UI_WORK_US;
+
+	while (g_get_monotonic_time() < end)
+		;
+
+	return TRUE;
+}
+
+/*
+ * Latency of incoming call notifications while the main loop is busy,
+ * delivered by the main loop or by the dispatcher thread
+ */
+static void perf_latency(gboolean with_dispatcher)
+{
+	telephony_data *data = fake_handle_new(with_dispatcher);
+	GThread *feeder;
+	guint busy_id;
+
+	g_atomic_int_set(&latency_count, 0);
+	telephony_set_noti_cb((telephony_h)data, TELEPHONY_NOTI_VOICE_CALL_STATUS_INCOMING, latency_cb, NULL);
+
+	busy_id = g_idle_add(busy_ui_cb, NULL);
+	feeder = g_thread_new("feeder", incoming_call_feeder, data);
+	while (g_atomic_int_get(&latency_count) < LATENCY_EVENTS)
+		g_main_context_iteration(NULL, FALSE);
+	g_thread_join(feeder);
+	g_source_remove(busy_id);
+
+	print_percentiles(with_dispatcher ? "Incoming call, dispatcher thread" : "Incoming call, main loop",
+		latency_samples, LATENCY_EVENTS);
+
+	fake_handle_free(data);
+}
+
+/* A network callback doing some work, as updating an indicator does */
+static void network_cb(telephony_h handle, telephony_noti_e noti_id, void *data, void *user_data)
+{
+	gint64 end = g_get_monotonic_time() + NETWORK_CB_WORK_US;
+
+	while (g_get_monotonic_time() < end)
+		;
+}
+
+static gint flood_running;
+
+/* Feeds signal strength and cell ID changes at a high rate, as in a poor coverage burst */
+static gpointer network_flood_feeder(gpointer user_data)
+{
+	telephony_data *data = user_data;
+	gint value = 0;
+
+	while (g_atomic_int_get(&flood_running)) {
+		value++;
+		fake_tapi_post(data, TAPI_PROP_NETWORK_SIGNALSTRENGTH_LEVEL, &value, sizeof(value));
+		fake_tapi_post(data, TAPI_PROP_NETWORK_CELLID, &value, sizeof(value));
+		g_usleep(FLOOD_INTERVAL_US);
+	}
+
+	return NULL;
+}
+
+/* Latency of incoming call notifications on the main loop during a network notification flood */
+static void perf_latency_under_flood(void)
+{
+	telephony_data *data = fake_handle_new(FALSE);
+	telephony_noti_queue_stats_s queue_stats;
+	telephony_noti_stats_s noti_stats;
+	GThread *flood, *feeder;
+
+	g_atomic_int_set(&latency_count, 0);
+	telephony_set_noti_cb((telephony_h)data, TELEPHONY_NOTI_VOICE_CALL_STATUS_INCOMING, latency_cb, NULL);
+	telephony_set_noti_cb((telephony_h)data, TELEPHONY_NOTI_NETWORK_SIGNALSTRENGTH_LEVEL, network_cb, NULL);
+	telephony_set_noti_cb((telephony_h)data, TELEPHONY_NOTI_NETWORK_CELLID, network_cb, NULL);
+
+	g_atomic_int_set(&flood_running, TRUE);
+	flood = g_thread_new("flood", network_flood_feeder, data);
+	feeder = g_thread_new("feeder", incoming_call_feeder, data);
+	while (g_atomic_int_get(&latency_count) < LATENCY_EVENTS)
+		g_main_context_iteration(NULL, FALSE);
+	g_thread_join(feeder);
+	g_atomic_int_set(&flood_running, FALSE);
+	g_thread_join(flood);
+	fake_drain();
+
+	print_percentiles("Incoming call, main loop", latency_samples, LATENCY_EVENTS);
+	telephony_get_noti_queue_stats((telephony_h)data, TELEPHONY_NOTI_CLASS_NETWORK, &queue_stats);
+	telephony_get_noti_stats((telephony_h)data, TELEPHONY_NOTI_NETWORK_SIGNALSTRENGTH_LEVEL, &noti_stats);
+	printf("Network queue: high water [%u], dropped [%u], signal strengths delivered [%u], suppressed [%u]\n",
+		queue_stats.high_water, queue_stats.dropped, noti_stats.delivered, noti_stats.suppressed);
+
+	fake_handle_free(data);
+}
+
+static gint replayed_count;
+
+static void count_cb(telephony_h handle, telephony_noti_e noti_id, void *data, void *user_data)
+{
+	g_atomic_int_inc(&replayed_count);
+}
+
+/* Cost of recording an event, and throughput of the replay at maximum speed */
+static void perf_recorder(void)
+{
+	telephony_data *data = fake_handle_new(FALSE);
+	telephony_handle_list_s list;
+	telephony_h handle = (telephony_h)data;
+	telephony_noti_record record;
+	char *path = g_build_filename(g_get_tmp_dir(), "test_noti_perf.rec", NULL);
+	unsigned int count = 0;
+	gint64 start;
+	unsigned int i;
+
+	printf("Recorder:\n");
+
+	if (telephony_noti_recorder_start(path, RECORDER_SIZE) != TELEPHONY_ERROR_NONE) {
+		printf("Cannot record to [%s]\n", path);
+		fake_handle_free(data);
+		g_free(path);
+		return;
+	}
+
+	/* The ring wraps many times, so that evictions are included */
+	memset(&record, 0, sizeof(record));
+	record.evt_id = TAPI_PROP_NETWORK_SIGNALSTRENGTH_LEVEL;
+	record.type = EVT_PAYLOAD_INT;
+	start = g_get_monotonic_time();
+	for (i = 0; i < ITERATIONS; i++) {
+		record.timestamp = g_get_monotonic_time();
+		record.value = i;
+		_telephony_noti_recorder_append(&record);
+	}
+	print_mean("Append, integer event", g_get_monotonic_time() - start, ITERATIONS);
+
+	record.evt_id = TAPI_PROP_NETWORK_NETWORK_NAME;
+	record.type = EVT_PAYLOAD_STRING;
+	record.string = "Operator name";
+	start = g_get_monotonic_time();
+	for (i = 0; i < ITERATIONS; i++) {
+		record.timestamp = g_get_monotonic_time();
+		_telephony_noti_recorder_append(&record);
+	}
+	print_mean("Append, string event", g_get_monotonic_time() - start, ITERATIONS);
+
+	/* A recording of changing signal strengths for the replay */
+	telephony_noti_recorder_stop();
+	telephony_noti_recorder_start(path, RECORDER_SIZE);
+	record.evt_id = TAPI_PROP_NETWORK_SIGNALSTRENGTH_LEVEL;
+	record.type = EVT_PAYLOAD_INT;
+	record.string = NULL;
+	for (i = 0; i < REPLAY_RECORDS; i++) {
+		record.timestamp = g_get_monotonic_time();
+		record.value = i;
+		_telephony_noti_recorder_append(&record);
+	}
+	telephony_noti_recorder_stop();
+
+	telephony_set_noti_cb(handle, TELEPHONY_NOTI_NETWORK_SIGNALSTRENGTH_LEVEL, count_cb, NULL);
+	list.count = 1;
+	list.handle = &handle;
+	g_atomic_int_set(&replayed_count, 0);
+	start = g_get_monotonic_time();
+	if (telephony_noti_replay(&list, path, false, &count) == TELEPHONY_ERROR_NONE && count > 0) {
+		/* Values replaced in the network lane before delivery are never counted */
+		gint64 end = start + 10 * G_USEC_PER_SEC;
+
+		while ((unsigned int)g_atomic_int_get(&replayed_count) < count && g_get_monotonic_time() < end)
+			g_main_context_iteration(NULL, FALSE);
+		print_mean("Replay at maximum speed, per event", g_get_monotonic_time() - start, count);
+		printf("Replayed [%d] of [%u] events\n", g_atomic_int_get(&replayed_count), count);
+	}
+
+	fake_handle_free(data);
+	unlink(path);
+	g_free(path);
+}
+
+int main(void)
+{
+	perf_feature_check();
+	perf_dispatch();
+	perf_dispatcher_round_trip();
+
+	printf("Delivery latency, main loop busy for %d us per iteration:\n", BUSY_UI_WORK_US);
+	perf_latency(FALSE);
+	perf_latency(TRUE);
+
+	printf("Delivery latency, network callbacks busy for %d us each during a flood:\n",
+		NETWORK_CB_WORK_US);
+	perf_latency_under_flood();
+
+	perf_recorder();
+
+	return 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2014 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Checks the rate limiting of notification callbacks: with the trailing
+ * edge, the values received during the interval must be coalesced into the
+ * latest one, delivered once the interval ends. Also checks that a value
+ * dropped by the policy does not let the value filter hold the callback on
+ * an older value.
+ */
+
+#include <stdio.h>
+#include <glib.h>
+#include <TelNetwork.h>
+
+#include "test_fake_handle.h"
+
+#define INTERVAL_MS 100
+#define RECEIVED_MAX 16
+
+typedef struct {
+	int values[RECEIVED_MAX];
+	gint64 times[RECEIVED_MAX];
+	gint count;
+} received_values;
+
+static void record_cb(telephony_h handle, telephony_noti_e noti_id, void *data, void *user_data)
+{
+	received_values *received = user_data;
+
+	if (received->count < RECEIVED_MAX) {
+		received->values[received->count] = *(int *)data;
+		received->times[received->count] = g_get_monotonic_time();
+		received->count++;
+	}
+}
+
+/* Sends a signal strength and lets it reach the callbacks */
+static void emit_signal_strength(telephony_data *data, int level)
+{
+	fake_tapi_emit_int(data, TAPI_PROP_NETWORK_SIGNALSTRENGTH_LEVEL, level);
+	fake_drain();
+}
+
+static int check_values(const char *step, const received_values *received,
+	const int *expected, int count)
+{
+	int i;
+
+	if (received->count != count) {
+		printf("FAIL: %s: [%d] values delivered, expected [%d]\n", step, received->count, count);
+		return 1;
+	}
+	for (i = 0; i < count; i++) {
+		if (received->values[i] != expected[i]) {
+			printf("FAIL: %s: value [%d] is [%d], expected [%d]\n", step, i,
+				received->values[i], expected[i]);
+			return 1;
+		}
+	}
+	printf("%s: [%d] values as expected\n", step, count);
+
+	return 0;
+}
+
+/* The values received during the interval end up as the latest one, at its end */
+static int check_trailing_edge(void)
+{
+	static const int expected[] = { 1, 4 };
+	telephony_data *data = fake_handle_new(FALSE);
+	telephony_noti_policy_s policy = { INTERVAL_MS, true };
+	telephony_noti_stats_s stats;
+	received_values received = { { 0 }, { 0 }, 0 };
+	int failed = 0;
+
+	telephony_set_noti_cb_with_policy((telephony_h)data, TELEPHONY_NOTI_NETWORK_SIGNALSTRENGTH_LEVEL,
+		&policy, record_cb, &received);
+
+	emit_signal_strength(data, 1);
+	emit_signal_strength(data, 2);
+	emit_signal_strength(data, 3);
+	emit_signal_strength(data, 4);
+	if (received.count != 1) {
+		printf("FAIL: trailing edge: [%d] values delivered within the interval\n", received.count);
+		failed = 1;
+	}
+
+	fake_wait_count(&received.count, 2);
+	failed |= check_values("trailing edge", &received, expected, 2);
+	if (received.count == 2 && received.times[1] - received.times[0] < INTERVAL_MS * 1000) {
+		printf("FAIL: trailing edge: delivered [%lld] us after the previous value\n",
+			(long long)(received.times[1] - received.times[0]));
+		failed = 1;
+	}
+
+	telephony_get_noti_stats((telephony_h)data, TELEPHONY_NOTI_NETWORK_SIGNALSTRENGTH_LEVEL, &stats);
+	if (stats.delivered != 2 || stats.suppressed != 2) {
+		printf("FAIL: trailing edge: [%u] delivered, [%u] suppressed, expected [2] and [2]\n",
+			stats.delivered, stats.suppressed);
+		failed = 1;
+	}
+
+	fake_handle_free(data);
+
+	return failed;
+}
+
+/* A value dropped by the policy is still delivered when it repeats after the interval */
+static int check_dropped_value_repeats(void)
+{
+	static const int expected[] = { 1, 2 };
+	telephony_data *data = fake_handle_new(FALSE);
+	telephony_noti_policy_s policy = { INTERVAL_MS, false };
+	received_values limited = { { 0 }, { 0 }, 0 };
+	received_values plain = { { 0 }, { 0 }, 0 };
+	int failed = 0;
+
+	telephony_set_noti_cb_with_policy((telephony_h)data, TELEPHONY_NOTI_NETWORK_SIGNALSTRENGTH_LEVEL,
+		&policy, record_cb, &limited);
+	telephony_set_noti_cb((telephony_h)data, TELEPHONY_NOTI_NETWORK_SIGNALSTRENGTH_LEVEL,
+		record_cb, &plain);
+
+	emit_signal_strength(data, 1);
+	/* Within the interval, dropped for the limited callback only */
+	emit_signal_strength(data, 2);
+	g_usleep(INTERVAL_MS * 1000);
+	/* Unchanged for the plain callback, which skips it */
+	emit_signal_strength(data, 2);
+
+	failed |= check_values("dropped value, limited callback", &limited, expected, 2);
+	failed |= check_values("dropped value, plain callback", &plain, expected, 2);
+
+	fake_handle_free(data);
+
+	return failed;
+}
+
+int main(void)
+{
+	int failed = 0;
+
+	failed |= check_trailing_edge();
+	failed |= check_dropped_value_repeats();
+
+	printf("%s\n", failed ? "FAILED" : "PASSED");
+
+	return failed;
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2014 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Checks the queues of the notification classes while the main loop is
+ * stalled: the status queue must deliver every call transition, even past
+ * TELEPHONY_NOTI_QUEUE_CAPACITY_MAX of them, the network queue must drop
+ * its oldest notification when full and count a replaced one as suppressed
+ * only.
+ */
+
+#include <stdio.h>
+#include <glib.h>
+#include <TelCall.h>
+#include <TelNetwork.h>
+
+#include "test_fake_handle.h"
+
+#define CALL_CYCLES 400
+#define RECEIVED_MAX (CALL_CYCLES * 3)
+
+static const struct {
+	const char *evt_id;
+	telephony_noti_e noti_id;
+} call_cycle[] = {
+	{ TAPI_NOTI_VOICE_CALL_STATUS_INCOMING, TELEPHONY_NOTI_VOICE_CALL_STATUS_INCOMING },
+	{ TAPI_NOTI_VOICE_CALL_STATUS_ACTIVE, TELEPHONY_NOTI_VOICE_CALL_STATUS_ACTIVE },
+	{ TAPI_NOTI_VOICE_CALL_STATUS_IDLE, TELEPHONY_NOTI_VOICE_CALL_STATUS_IDLE },
+};
+
+#define CALL_CYCLE_LEN (sizeof(call_cycle) / sizeof(call_cycle[0]))
+
+static struct {
+	telephony_noti_e noti_id;
+	int value;
+} received[RECEIVED_MAX];
+static gint received_count;
+
+static void record_cb(telephony_h handle, telephony_noti_e noti_id, void *data, void *user_data)
+{
+	if (received_count < RECEIVED_MAX) {
+		received[received_count].noti_id = noti_id;
+		received[received_count].value = *(int *)data;
+		received_count++;
+	}
+}
+
+static int check_queue_stats(telephony_data *data, telephony_noti_class_e noti_class,
+	unsigned int depth, unsigned int high_water, unsigned int dropped)
+{
+	telephony_noti_queue_stats_s stats;
+	int ret;
+
+	ret = telephony_get_noti_queue_stats((telephony_h)data, noti_class, &stats);
+	if (ret != TELEPHONY_ERROR_NONE || stats.depth != depth
+			|| stats.high_water != high_water || stats.dropped != dropped) {
+		printf("FAIL: class [%d]: ret [%d], depth [%u], high water [%u], dropped [%u], "
+			"expected [%u], [%u], [%u]\n", noti_class, ret, stats.depth, stats.high_water,
+			stats.dropped, depth, high_water, dropped);
+		return 1;
+	}
+
+	return 0;
+}
+
+/* More call transitions than any queue capacity, all delivered in order */
+static int check_status_never_drops(void)
+{
+	telephony_data *data = fake_handle_new(FALSE);
+	unsigned int cycle, i;
+	int failed = 0;
+
+	received_count = 0;
+	for (i = 0; i < CALL_CYCLE_LEN; i++)
+		telephony_set_noti_cb((telephony_h)data, call_cycle[i].noti_id, record_cb, NULL);
+
+	for (cycle = 0; cycle < CALL_CYCLES; cycle++) {
+		for (i = 0; i < CALL_CYCLE_LEN; i++)
+			fake_tapi_emit_call(data, call_cycle[i].evt_id, cycle + 1);
+	}
+	failed |= check_queue_stats(data, TELEPHONY_NOTI_CLASS_STATUS, RECEIVED_MAX, RECEIVED_MAX, 0);
+
+	if (!fake_wait_count(&received_count, RECEIVED_MAX)) {
+		printf("FAIL: [%d] call events delivered, expected [%d]\n", received_count, RECEIVED_MAX);
+		failed = 1;
+	}
+	for (i = 0; i < (unsigned int)received_count; i++) {
+		if (received[i].noti_id != call_cycle[i % CALL_CYCLE_LEN].noti_id
+				|| received[i].value != (int)(i / CALL_CYCLE_LEN) + 1) {
+			printf("FAIL: call event [%u] is noti [%d] of call [%d]\n", i,
+				received[i].noti_id, received[i].value);
+			failed = 1;
+			break;
+		}
+	}
+	failed |= check_queue_stats(data, TELEPHONY_NOTI_CLASS_STATUS, 0, RECEIVED_MAX, 0);
+	if (!failed)
+		printf("Status queue: [%d] call events in order, none dropped\n", received_count);
+
+	fake_handle_free(data);
+
+	return failed;
+}
+
+/* A replaced network notification is suppressed, one beyond the capacity is dropped */
+static int check_network_drops_oldest(void)
+{
+	telephony_data *data = fake_handle_new(FALSE);
+	telephony_noti_stats_s noti_stats;
+	int failed = 0;
+
+	received_count = 0;
+	telephony_set_noti_cb((telephony_h)data, TELEPHONY_NOTI_NETWORK_SIGNALSTRENGTH_LEVEL, record_cb, NULL);
+	telephony_set_noti_cb((telephony_h)data, TELEPHONY_NOTI_NETWORK_CELLID, record_cb, NULL);
+	telephony_set_noti_cb((telephony_h)data, TELEPHONY_NOTI_NETWORK_ROAMING_STATUS, record_cb, NULL);
+	if (telephony_set_noti_queue_policy((telephony_h)data, TELEPHONY_NOTI_CLASS_NETWORK, 2,
+			TELEPHONY_NOTI_OVERFLOW_DROP_OLDEST) != TELEPHONY_ERROR_NONE) {
+		printf("FAIL: telephony_set_noti_queue_policy() failed\n");
+		fake_handle_free(data);
+		return 1;
+	}
+
+	fake_tapi_emit_int(data, TAPI_PROP_NETWORK_SIGNALSTRENGTH_LEVEL, 1);
+	fake_tapi_emit_int(data, TAPI_PROP_NETWORK_CELLID, 100);
+	/* Replaces the pending signal strength, the queue is not full */
+	fake_tapi_emit_int(data, TAPI_PROP_NETWORK_SIGNALSTRENGTH_LEVEL, 2);
+	failed |= check_queue_stats(data, TELEPHONY_NOTI_CLASS_NETWORK, 2, 2, 0);
+	/* A third property, the signal strength is the oldest */
+	fake_tapi_emit_int(data, TAPI_PROP_NETWORK_ROAMING_STATUS, 1);
+	failed |= check_queue_stats(data, TELEPHONY_NOTI_CLASS_NETWORK, 2, 2, 1);
+
+	telephony_get_noti_stats((telephony_h)data, TELEPHONY_NOTI_NETWORK_SIGNALSTRENGTH_LEVEL, &noti_stats);
+	if (noti_stats.suppressed != 1) {
+		printf("FAIL: [%u] signal strengths suppressed, expected [1]\n", noti_stats.suppressed);
+		failed = 1;
+	}
+
+	fake_wait_count(&received_count, 2);
+	fake_drain();
+	if (received_count != 2
+			|| received[0].noti_id != TELEPHONY_NOTI_NETWORK_CELLID || received[0].value != 100
+			|| received[1].noti_id != TELEPHONY_NOTI_NETWORK_ROAMING_STATUS || received[1].value != 1) {
+		printf("FAIL: [%d] network events delivered, expected the cell ID and the roaming status\n",
+			received_count);
+		failed = 1;
+	}
+	if (!failed)
+		printf("Network queue: oldest dropped, replaced one suppressed\n");
+
+	fake_handle_free(data);
+
+	return failed;
+}
+
+int main(void)
+{
+	int failed = 0;
+
+	failed |= check_status_never_drops();
+	failed |= check_network_drops_oldest();
+
+	printf("%s\n", failed ? "FAILED" : "PASSED");
+
+	return failed;
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2014 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Checks that a recorded call cycle is replayed: the call status events of
+ * a fake handle are recorded while they are delivered, then replayed to the
+ * same handle, whose callback must see them again in the same order. The
+ * call events are fed as the call table does, so neither the telephony
+ * daemon nor a modem is needed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <glib.h>
+#include <TelCall.h>
+
+#include <telephony.h>
+#include "telephony_private.h"
+
+#define CALL_ID 1
+#define RECEIVED_MAX 16
+/* Of the record count in the header of a recording file, after magic, version, size, head and tail */
+#define RECORD_COUNT_OFFSET (5 * sizeof(guint32))
+
+static const struct {
+	const char *evt_id;
+	telephony_noti_e noti_id;
+} call_cycle[] = {
+	{ TAPI_NOTI_VOICE_CALL_STATUS_INCOMING, TELEPHONY_NOTI_VOICE_CALL_STATUS_INCOMING },
+	{ TAPI_NOTI_VOICE_CALL_STATUS_ACTIVE, TELEPHONY_NOTI_VOICE_CALL_STATUS_ACTIVE },
+	{ TAPI_NOTI_VOICE_CALL_STATUS_IDLE, TELEPHONY_NOTI_VOICE_CALL_STATUS_IDLE },
+};
+
+#define CALL_CYCLE_LEN (sizeof(call_cycle) / sizeof(call_cycle[0]))
+
+static telephony_noti_e received[RECEIVED_MAX];
+static unsigned int received_count;
+
+static void call_status_cb(telephony_h handle, telephony_noti_e noti_id, void *data, void *user_data)
+{
+	if (*(unsigned int *)data == CALL_ID && received_count < RECEIVED_MAX)
+		received[received_count++] = noti_id;
+}
+
+/* Runs the main loop until count events were received, for a second at most */
+static void wait_events(unsigned int count)
+{
+	gint64 end = g_get_monotonic_time() + G_USEC_PER_SEC;
+
+	while (received_count < count && g_get_monotonic_time() < end) {
+		if (!g_main_context_iteration(NULL, FALSE))
+			g_usleep(1000);
+	}
+}
+
+static int check_call_cycle(const char *step)
+{
+	unsigned int i;
+
+	if (received_count != CALL_CYCLE_LEN) {
+		printf("FAIL: %s: [%u] events, expected [%u]\n", step,
+			received_count, (unsigned int)CALL_CYCLE_LEN);
+		return 1;
+	}
+
+	for (i = 0; i < CALL_CYCLE_LEN; i++) {
+		if (received[i] != call_cycle[i].noti_id) {
+			printf("FAIL: %s: event [%u] is noti [%d], expected [%d]\n", step,
+				i, received[i], call_cycle[i].noti_id);
+			return 1;
+		}
+	}
+
+	printf("%s: [%u] events in order\n", step, received_count);
+
+	return 0;
+}
+
+/* A recording claiming more records than its ring can hold is rejected */
+static int check_corrupted_count(telephony_handle_list_s *list, const char *path)
+{
+	guint32 corrupted = 0xffffffff;
+	unsigned int count = 0;
+	int fd;
+	int ret;
+
+	fd = open(path, O_WRONLY);
+	if (fd < 0 || pwrite(fd, &corrupted, sizeof(corrupted), RECORD_COUNT_OFFSET) != sizeof(corrupted)) {
+		printf("FAIL: cannot corrupt [%s]\n", path);
+		if (fd >= 0)
+			close(fd);
+		return 1;
+	}
+	close(fd);
+
+	ret = telephony_noti_replay(list, path, false, &count);
+	if (ret != TELEPHONY_ERROR_OPERATION_FAILED) {
+		printf("FAIL: corrupted count: telephony_noti_replay() returned [%d]\n", ret);
+		return 1;
+	}
+	printf("corrupted count: rejected\n");
+
+	return 0;
+}
+
+int main(void)
+{
+	struct tapi_handle tapi_h;
+	telephony_data *data = g_new0(telephony_data, 1);
+	telephony_h handle = (telephony_h)data;
+	telephony_handle_list_s list;
+	char *path = g_build_filename(g_get_tmp_dir(), "test_noti_replay.rec", NULL);
+	unsigned int count = 0;
+	int failed = 0;
+	unsigned int i;
+	int ret;
+
+	/* A handle whose call events come from the call table, not from TAPI */
+	memset(&tapi_h, 0, sizeof(tapi_h));
+	data->tapi_h = &tapi_h;
+	data->context = g_main_context_ref_thread_default();
+	g_mutex_init(&data->call_table.mutex);
+	data->call_table.calls = g_array_new(FALSE, TRUE, sizeof(telephony_call_info_s));
+	data->call_table.valid = TRUE;
+	data->call_table.call_signal_id = 1;
+	_telephony_noti_registry_init(data);
+	list.count = 1;
+	list.handle = &handle;
+
+	for (i = 0; i < CALL_CYCLE_LEN; i++) {
+		ret = telephony_set_noti_cb(handle, call_cycle[i].noti_id, call_status_cb, NULL);
+		if (ret != TELEPHONY_ERROR_NONE) {
+			printf("FAIL: telephony_set_noti_cb() returned [%d]\n", ret);
+			return 1;
+		}
+	}
+
+	ret = telephony_noti_recorder_start(path, TELEPHONY_NOTI_RECORDER_SIZE_MIN);
+	if (ret != TELEPHONY_ERROR_NONE) {
+		printf("FAIL: telephony_noti_recorder_start() returned [%d]\n", ret);
+		return 1;
+	}
+	for (i = 0; i < CALL_CYCLE_LEN; i++)
+		_telephony_noti_dispatch_call_status(data, call_cycle[i].evt_id, CALL_ID);
+	wait_events(CALL_CYCLE_LEN);
+	telephony_noti_recorder_stop();
+	failed |= check_call_cycle("live");
+
+	received_count = 0;
+	ret = telephony_noti_replay(&list, path, false, &count);
+	if (ret != TELEPHONY_ERROR_NONE || count != CALL_CYCLE_LEN) {
+		printf("FAIL: telephony_noti_replay() returned [%d], count [%u]\n", ret, count);
+		failed = 1;
+	} else if (received_count != 0) {
+		printf("FAIL: [%u] events delivered before the main loop ran\n", received_count);
+		failed = 1;
+	} else {
+		wait_events(CALL_CYCLE_LEN);
+		failed |= check_call_cycle("replayed");
+	}
+	failed |= check_corrupted_count(&list, path);
+
+	_telephony_noti_replay_cancel(data);
+	_telephony_noti_registry_deinit(data);
+	g_array_free(data->call_table.calls, TRUE);
+	g_mutex_clear(&data->call_table.mutex);
+	g_main_context_unref(data->context);
+	g_free(data);
+	unlink(path);
+	g_free(path);
+
+	printf("%s\n", failed ? "FAILED" : "PASSED");
+
+	return failed;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2014 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the License);
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Checks the delivery timing of notifications: a callback must read times
+ * which follow the notification through the library, and the latency and
+ * duration histograms must count a delayed notification and a long callback
+ * in their buckets.
+ */
+
+#include <stdio.h>
+#include <glib.h>
+#include <TelNetwork.h>
+
+#include "test_fake_handle.h"
+
+/* Long enough to be told from the other steps of a delivery */
+#define DELAY_US 3000
+
+static telephony_noti_timing_s timing;
+static int timing_ret;
+static gint64 callback_end;
+static gint delivered;
+
+static void timing_cb(telephony_h handle, telephony_noti_e noti_id, void *data, void *user_data)
+{
+	timing_ret = telephony_noti_get_timing(&timing);
+	g_usleep(DELAY_US);
+	callback_end = g_get_monotonic_time();
+	g_atomic_int_inc(&delivered);
+}
+
+/* The only non empty bucket of histogram must hold one duration of at least DELAY_US */
+static int check_histogram(const char *name, const unsigned int *histogram)
+{
+	unsigned int total = 0;
+	int bucket = -1;
+	int i;
+
+	for (i = 0; i < TELEPHONY_NOTI_HISTOGRAM_BUCKETS; i++) {
+		total += histogram[i];
+		if (histogram[i])
+			bucket = i;
+	}
+	if (total != 1 || (1u << (bucket + 1)) <= DELAY_US) {
+		printf("FAIL: %s: [%u] durations, bucket [%d]\n", name, total, bucket);
+		return 1;
+	}
+	printf("%s: in bucket [%d]\n", name, bucket);
+
+	return 0;
+}
+
+int main(void)
+{
+	telephony_data *data = fake_handle_new(FALSE);
+	telephony_noti_stats_s stats;
+	gint64 emitted;
+	int failed = 0;
+
+	if (telephony_noti_get_timing(&timing) != TELEPHONY_ERROR_INVALID_PARAMETER) {
+		printf("FAIL: timing read outside of a callback\n");
+		failed = 1;
+	}
+
+	telephony_set_noti_cb((telephony_h)data, TELEPHONY_NOTI_NETWORK_CELLID, timing_cb, NULL);
+
+	/* The main loop is late by DELAY_US to deliver the notification */
+	emitted = g_get_monotonic_time();
+	fake_tapi_emit_int(data, TAPI_PROP_NETWORK_CELLID, 100);
+	g_usleep(DELAY_US);
+	fake_wait_count(&delivered, 1);
+
+	if (g_atomic_int_get(&delivered) != 1 || timing_ret != TELEPHONY_ERROR_NONE) {
+		printf("FAIL: [%d] notifications delivered, timing read with [%d]\n",
+			g_atomic_int_get(&delivered), timing_ret);
+		failed = 1;
+	} else if (timing.received < (unsigned long long)emitted
+			|| timing.dispatched < timing.received + DELAY_US
+			|| timing.callback_start < timing.dispatched
+			|| (unsigned long long)callback_end < timing.callback_start + DELAY_US) {
+		printf("FAIL: received [%llu], dispatched [%llu], callback [%llu], emitted [%lld], returned [%lld]\n",
+			timing.received, timing.dispatched, timing.callback_start,
+			(long long)emitted, (long long)callback_end);
+		failed = 1;
+	} else {
+		printf("timing: dispatched [%llu] us and invoked [%llu] us after the reception\n",
+			timing.dispatched - timing.received, timing.callback_start - timing.received);
+	}
+
+	telephony_get_noti_stats((telephony_h)data, TELEPHONY_NOTI_NETWORK_CELLID, &stats);
+	failed |= check_histogram("latency", stats.latency_histogram);
+	failed |= check_histogram("duration", stats.duration_histogram);
+
+	fake_handle_free(data);
+
+	printf("%s\n", failed ? "FAILED" : "PASSED");
+
+	return failed;
+}